@@ -0,0 +1,491 @@
+#include "BigInt.hpp"
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef BIGINT_BENCH_GMP
+#include <gmp.h>
+#endif
+
+// Замеры BigInt по размерам операндов: для каждой операции и каждого алгоритма - ns/op и limbs/s.
+// Размеры идут степенями двойки от --min-limbs до --max-limbs (по умолчанию 1 .. 10^6 разрядов по 10^9);
+// у квадратичных алгоритмов свой потолок, а серия обрывается, когда одна операция дольше --max-seconds.
+// Вывод - таблица, CSV или JSON; с --gmp рядом замеряются те же операции в GMP (если он найден при сборке)
+
+namespace
+{
+
+// Тело замера возвращает что-нибудь от результата, чтобы вычисление не выбросил оптимизатор
+using Body = std::function<size_t()>;
+
+struct Benchmark
+{
+    std::string operation, algorithm;
+    size_t max_limbs;
+    std::function<Body(size_t)> prepare;
+};
+
+struct Result
+{
+    std::string operation, algorithm;
+    size_t limbs, iterations;
+    double ns_per_op, limbs_per_second;
+};
+
+struct Options
+{
+    size_t min_limbs = 1, max_limbs = 1000000;
+    double min_time = 0.2, max_seconds = 10;
+    std::string format = "table", filter, out;
+    bool gmp = false, list = false;
+};
+
+// Случайное число из limbs разрядов по 10^9 десятичной строкой; старшая цифра ненулевая.
+// coprime - число взаимно просто с 10, то есть годится в модуль Монтгомери
+std::string random_digits(std::mt19937_64 &rng, size_t limbs, bool coprime = false)
+{
+    std::string digits(limbs * 9, '0');
+    for (char &c : digits)
+    {
+        c = (char)('0' + rng() % 10);
+    }
+    digits.front() = (char)('1' + rng() % 9);
+    if (coprime)
+    {
+        digits.back() = "1379"[rng() % 4];
+    }
+    return digits;
+}
+
+size_t sink(const BigInt &value)
+{
+    return value.is_odd() ? 1 : 0;
+}
+
+std::vector<Benchmark> bigint_benchmarks()
+{
+    // Операнды строятся один раз на размер, вне замера
+    auto binary = [](auto operation)
+    {
+        return [operation](size_t n) -> Body
+        {
+            std::mt19937_64 rng(n);
+            auto a = std::make_shared<BigInt>(random_digits(rng, n)), b = std::make_shared<BigInt>(random_digits(rng, n));
+            return [operation, a, b] { return sink(operation(*a, *b)); };
+        };
+    };
+    auto division = [](auto operation)
+    {
+        return [operation](size_t n) -> Body
+        {
+            std::mt19937_64 rng(n);
+            auto a = std::make_shared<BigInt>(random_digits(rng, 2 * n)), b = std::make_shared<BigInt>(random_digits(rng, n));
+            return [operation, a, b] { return sink(operation(*a, *b)); };
+        };
+    };
+
+    return {
+        {"mul", "schoolbook", size_t(1) << 13, binary([](const BigInt &a, const BigInt &b) { return a * b; })},
+        {"mul", "karatsuba", 1000000, binary([](const BigInt &a, const BigInt &b) { return a.karatsuba_multiply(b); })},
+        {"mul", "fft", 1000000, binary([](const BigInt &a, const BigInt &b) { return a.fft_multiply(b); })},
+        {"sqr", "karatsuba", 1000000, binary([](const BigInt &a, const BigInt &) { return a.karatsuba_multiply(a); })},
+        {"mul_low", "truncated", 1000000,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto a = std::make_shared<BigInt>(random_digits(rng, n)), b = std::make_shared<BigInt>(random_digits(rng, n));
+             return [a, b, n] { return sink(a->mul_low(*b, n)); };
+         }},
+        {"div", "long", size_t(1) << 8, division([](const BigInt &a, const BigInt &b) { return a / b; })},
+        {"div", "newton", 1000000, division([](const BigInt &a, const BigInt &b) { return a.newton_divide(b); })},
+        {"parse", "decimal", 1000000,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto text = std::make_shared<std::string>(random_digits(rng, n));
+             return [text] { return sink(BigInt(*text)); };
+         }},
+        {"print", "decimal", 1000000,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto a = std::make_shared<BigInt>(random_digits(rng, n));
+             return [a] { return a->to_string(10).size(); };
+         }},
+        {"print", "hex", size_t(1) << 16,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto a = std::make_shared<BigInt>(random_digits(rng, n));
+             return [a] { return a->to_string(16).size(); };
+         }},
+        {"mod_exp", "montgomery", size_t(1) << 9,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto base = std::make_shared<BigInt>(random_digits(rng, n)), exp = std::make_shared<BigInt>(random_digits(rng, n)),
+                  mod = std::make_shared<BigInt>(random_digits(rng, n, true));
+             return [base, exp, mod] { return sink(base->mod_exp(*exp, *mod)); };
+         }},
+        {"mod_exp", "generic", size_t(1) << 5,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto base = std::make_shared<BigInt>(random_digits(rng, n)), exp = std::make_shared<BigInt>(random_digits(rng, n)),
+                  mod = std::make_shared<BigInt>(random_digits(rng, n) + "0");
+             return [base, exp, mod] { return sink(base->mod_exp(*exp, *mod)); };
+         }},
+        {"gcd", "hgcd", size_t(1) << 16, binary([](const BigInt &a, const BigInt &b) { return BigInt::gcd(a, b); })},
+        {"isqrt", "newton", size_t(1) << 16,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto a = std::make_shared<BigInt>(random_digits(rng, n));
+             return [a] { return sink(a->isqrt()); };
+         }},
+    };
+}
+
+#ifdef BIGINT_BENCH_GMP
+
+class Mpz
+{
+public:
+    explicit Mpz(const std::string &digits = "0")
+    {
+        mpz_init_set_str(value, digits.c_str(), 10);
+    }
+
+    Mpz(const Mpz &) = delete;
+    Mpz &operator=(const Mpz &) = delete;
+
+    ~Mpz()
+    {
+        mpz_clear(value);
+    }
+
+    mpz_t value;
+};
+
+size_t sink(const Mpz &value)
+{
+    return mpz_odd_p(value.value) ? 1 : 0;
+}
+
+// Те же операции и те же операнды в GMP; алгоритм GMP выбирает сам
+std::vector<Benchmark> gmp_benchmarks()
+{
+    using Operation = void (*)(mpz_ptr, mpz_srcptr, mpz_srcptr);
+    auto with_sizes = [](Operation operation, size_t a_factor)
+    {
+        return [operation, a_factor](size_t n) -> Body
+        {
+            std::mt19937_64 rng(n);
+            auto a = std::make_shared<Mpz>(random_digits(rng, a_factor * n)), b = std::make_shared<Mpz>(random_digits(rng, n));
+            auto result = std::make_shared<Mpz>();
+            return [operation, a, b, result]
+            {
+                operation(result->value, a->value, b->value);
+                return sink(*result);
+            };
+        };
+    };
+
+    return {
+        {"mul", "gmp", 1000000, with_sizes(mpz_mul, 1)},
+        {"sqr", "gmp", 1000000, with_sizes([](mpz_ptr r, mpz_srcptr a, mpz_srcptr) { mpz_mul(r, a, a); }, 1)},
+        {"div", "gmp", 1000000, with_sizes(mpz_tdiv_q, 2)},
+        {"parse", "gmp", 1000000,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto text = std::make_shared<std::string>(random_digits(rng, n));
+             auto result = std::make_shared<Mpz>();
+             return [text, result]
+             {
+                 mpz_set_str(result->value, text->c_str(), 10);
+                 return sink(*result);
+             };
+         }},
+        {"print", "gmp", 1000000,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto a = std::make_shared<Mpz>(random_digits(rng, n));
+             return [a]
+             {
+                 std::unique_ptr<char, void (*)(void *)> text(mpz_get_str(nullptr, 10, a->value), std::free);
+                 return std::strlen(text.get());
+             };
+         }},
+        {"mod_exp", "gmp", size_t(1) << 9,
+         [](size_t n) -> Body
+         {
+             std::mt19937_64 rng(n);
+             auto base = std::make_shared<Mpz>(random_digits(rng, n)), exp = std::make_shared<Mpz>(random_digits(rng, n)),
+                  mod = std::make_shared<Mpz>(random_digits(rng, n, true));
+             auto result = std::make_shared<Mpz>();
+             return [base, exp, mod, result]
+             {
+                 mpz_powm(result->value, base->value, exp->value, mod->value);
+                 return sink(*result);
+             };
+         }},
+        {"gcd", "gmp", size_t(1) << 16, with_sizes(mpz_gcd, 1)},
+        {"isqrt", "gmp", size_t(1) << 16, with_sizes([](mpz_ptr r, mpz_srcptr a, mpz_srcptr) { mpz_sqrt(r, a); }, 1)},
+    };
+}
+
+#endif
+
+// Один прогон - оценка; если он короче min_time, повторяем столько раз, чтобы набрать min_time
+Result measure(const Benchmark &benchmark, size_t n, const Options &options)
+{
+    using clock = std::chrono::steady_clock;
+    Body body = benchmark.prepare(n);
+    volatile size_t result = 0;
+
+    clock::time_point start = clock::now();
+    result = result + body();
+    double elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    size_t iterations = 1;
+    if (elapsed < options.min_time)
+    {
+        iterations = (size_t)(options.min_time / std::max(elapsed, 1e-9)) + 1;
+        start = clock::now();
+        for (size_t i = 0; i < iterations; i++)
+        {
+            result = result + body();
+        }
+        elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    }
+
+    const double ns = elapsed * 1e9 / (double)iterations;
+    return {benchmark.operation, benchmark.algorithm, n, iterations, ns, (double)n * 1e9 / ns};
+}
+
+std::vector<size_t> sizes(const Options &options)
+{
+    std::vector<size_t> result;
+    for (size_t n = std::max<size_t>(1, options.min_limbs); n <= options.max_limbs; n *= 2)
+    {
+        result.push_back(n);
+    }
+    if (result.empty() || result.back() != options.max_limbs)
+    {
+        result.push_back(options.max_limbs);
+    }
+    return result;
+}
+
+// Таблица и CSV выводятся построчно по мере замеров, JSON - массивом в конце
+class Reporter
+{
+public:
+    Reporter(std::ostream &out, const Options &options) : _out(out), _format(options.format)
+    {
+        if (_format == "csv")
+        {
+            _out << "operation,algorithm,limbs,iterations,ns_per_op,limbs_per_second\n";
+        }
+        else if (_format == "json")
+        {
+            _out << "{\n  \"context\": {\"limb_base\": 1000000000, \"min_time\": " << options.min_time << ", \"gmp\": " << (options.gmp ? "true" : "false")
+                 << "},\n  \"benchmarks\": [";
+        }
+        else
+        {
+            _out << std::left << std::setw(10) << "operation" << std::setw(12) << "algorithm" << std::right << std::setw(10) << "limbs" << std::setw(12)
+                 << "iterations" << std::setw(18) << "ns/op" << std::setw(16) << "limbs/s" << '\n';
+        }
+    }
+
+    void add(const Result &result)
+    {
+        if (_format == "csv")
+        {
+            _out << result.operation << ',' << result.algorithm << ',' << result.limbs << ',' << result.iterations << ',' << std::fixed
+                 << std::setprecision(1) << result.ns_per_op << ',' << result.limbs_per_second << std::defaultfloat << '\n';
+        }
+        else if (_format == "json")
+        {
+            _out << (_first ? "\n" : ",\n") << "    {\"name\": \"" << result.operation << '/' << result.algorithm << '/' << result.limbs
+                 << "\", \"operation\": \"" << result.operation << "\", \"algorithm\": \"" << result.algorithm << "\", \"limbs\": " << result.limbs
+                 << ", \"iterations\": " << result.iterations << std::fixed << std::setprecision(1) << ", \"ns_per_op\": " << result.ns_per_op
+                 << ", \"limbs_per_second\": " << result.limbs_per_second << std::defaultfloat << '}';
+        }
+        else
+        {
+            _out << std::left << std::setw(10) << result.operation << std::setw(12) << result.algorithm << std::right << std::setw(10) << result.limbs
+                 << std::setw(12) << result.iterations << std::fixed << std::setprecision(1) << std::setw(18) << result.ns_per_op << std::setw(16)
+                 << std::setprecision(0) << result.limbs_per_second << std::defaultfloat << '\n';
+        }
+        _out.flush();
+        _first = false;
+    }
+
+    ~Reporter()
+    {
+        if (_format == "json")
+        {
+            _out << "\n  ]\n}\n";
+        }
+    }
+
+private:
+    std::ostream &_out;
+    std::string _format;
+    bool _first = true;
+};
+
+// --name=value
+bool parse_option(std::string_view arg, std::string_view name, std::string &value)
+{
+    if (!arg.starts_with("--") || arg.substr(2, name.size()) != name || arg.substr(2 + name.size(), 1) != "=")
+    {
+        return false;
+    }
+    value = arg.substr(3 + name.size());
+    return true;
+}
+
+Options parse_options(int argc, char **argv)
+{
+    Options options;
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        std::string value;
+        if (parse_option(arg, "min-limbs", value))
+        {
+            options.min_limbs = std::stoull(value);
+        }
+        else if (parse_option(arg, "max-limbs", value))
+        {
+            options.max_limbs = std::stoull(value);
+        }
+        else if (parse_option(arg, "min-time", value))
+        {
+            options.min_time = std::stod(value);
+        }
+        else if (parse_option(arg, "max-seconds", value))
+        {
+            options.max_seconds = std::stod(value);
+        }
+        else if (parse_option(arg, "format", value) && (value == "table" || value == "csv" || value == "json"))
+        {
+            options.format = value;
+        }
+        else if (parse_option(arg, "filter", value))
+        {
+            options.filter = value;
+        }
+        else if (parse_option(arg, "out", value))
+        {
+            options.out = value;
+        }
+        else if (arg == "--gmp")
+        {
+            options.gmp = true;
+        }
+        else if (arg == "--list")
+        {
+            options.list = true;
+        }
+        else
+        {
+            throw std::exception();
+        }
+    }
+    if (options.min_limbs == 0 || options.min_limbs > options.max_limbs)
+    {
+        throw std::exception();
+    }
+    return options;
+}
+
+void usage()
+{
+    std::cerr << "usage: bigint_bench [--min-limbs=N] [--max-limbs=N] [--min-time=SEC] [--max-seconds=SEC]\n"
+                 "                    [--format=table|csv|json] [--filter=SUBSTR] [--out=FILE] [--gmp] [--list]\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options options;
+    try
+    {
+        options = parse_options(argc, argv);
+    }
+    catch (const std::exception &)
+    {
+        usage();
+        return 2;
+    }
+
+    std::vector<Benchmark> benchmarks = bigint_benchmarks();
+    if (options.gmp)
+    {
+#ifdef BIGINT_BENCH_GMP
+        for (Benchmark &benchmark : gmp_benchmarks())
+        {
+            benchmarks.push_back(std::move(benchmark));
+        }
+#else
+        std::cerr << "bigint_bench: собран без GMP, сравнение недоступно\n";
+        return 2;
+#endif
+    }
+    std::erase_if(benchmarks, [&options](const Benchmark &benchmark)
+                  { return (benchmark.operation + '/' + benchmark.algorithm).find(options.filter) == std::string::npos; });
+    // Одинаковые операции рядом, чтобы GMP шёл сразу за своими аналогами
+    std::stable_sort(benchmarks.begin(), benchmarks.end(), [](const Benchmark &a, const Benchmark &b) { return a.operation < b.operation; });
+
+    if (options.list)
+    {
+        for (const Benchmark &benchmark : benchmarks)
+        {
+            std::cout << benchmark.operation << '/' << benchmark.algorithm << " (до " << benchmark.max_limbs << " разрядов)\n";
+        }
+        return 0;
+    }
+
+    std::ofstream file;
+    if (!options.out.empty())
+    {
+        file.open(options.out);
+        if (!file)
+        {
+            std::cerr << "bigint_bench: не удалось открыть " << options.out << '\n';
+            return 1;
+        }
+    }
+    Reporter reporter(options.out.empty() ? std::cout : file, options);
+    for (const Benchmark &benchmark : benchmarks)
+    {
+        for (size_t n : sizes(options))
+        {
+            if (n > benchmark.max_limbs)
+            {
+                break;
+            }
+            const Result result = measure(benchmark, n, options);
+            reporter.add(result);
+            if (result.ns_per_op * 1e-9 > options.max_seconds)
+            {
+                break;
+            }
+        }
+    }
+    return 0;
+}
@@ -6,14 +6,80 @@
 #include <climits>
 #include <algorithm>
 #include <exception>
+#include <compare>
+#include <concepts>
+#include <functional>
+#include <bit>
+#include <cstdint>
+#include <random>
+#include <future>
+#include <stop_token>
+#include <deque>
+#include <map>
+#include <string>
+#include <charconv>
+#include <cctype>
 #include <cmath>
+#include <array>
+#include <limits>
+#include <cstdlib>
+#include <new>
+#include "LimbBuffer.hpp"
+
+#ifdef BIGINT_TELEMETRY
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#endif
 
 #define NUMBER_LENGTH(x) (std::to_string(x).length())
 
+// Точка замера телеметрии до конца блока; без BIGINT_TELEMETRY не порождает кода
+#ifdef BIGINT_TELEMETRY
+#define BIGINT_TELEMETRY_SCOPE(op, limbs) const TelemetryScope telemetry_scope((op), (limbs))
+#else
+#define BIGINT_TELEMETRY_SCOPE(op, limbs) ((void)0)
+#endif
+
+// Подставляется в одном .cpp программы: глобальные operator new/delete отмечают выделения памяти
+// для телеметрии. Без этого счётчик выделений остаётся нулевым. GCC, видя пару malloc/free
+// за заменёнными new/delete, ошибочно считает их несогласованными - предупреждение отключено
+#define BIGINT_TELEMETRY_ALLOCATION_HOOKS                     \
+    _Pragma("GCC diagnostic push")                            \
+    _Pragma("GCC diagnostic ignored \"-Wmismatched-new-delete\"") \
+    void *operator new(std::size_t size)                      \
+    {                                                         \
+        BigInt::telemetry_note_allocation();                  \
+        if (void *p = std::malloc(size != 0 ? size : 1))      \
+        {                                                     \
+            return p;                                         \
+        }                                                     \
+        throw std::bad_alloc();                               \
+    }                                                         \
+    void operator delete(void *p) noexcept                    \
+    {                                                         \
+        std::free(p);                                         \
+    }                                                         \
+    void operator delete(void *p, std::size_t) noexcept       \
+    {                                                         \
+        std::free(p);                                         \
+    }                                                         \
+    _Pragma("GCC diagnostic pop")
+
 const long double PI = std::acos(-1);
 
 class BigInt
 {
+    template <size_t>
+    friend class FixedBigInt;
+    friend class BigIntFile;
+    friend class MappedBigInt;
+    friend class RnsBasis;
+    friend class FixedBaseExponentiator;
+    friend class Poly;
+    friend class OutOfCoreMultiplier;
+    friend class Recurrence;
+
 public:
     BigInt()
     {
@@ -29,28 +95,18 @@ public:
             return;
         }
 
-        if (value < 0)
-        {
-            isNegative = true;
-            value = -value;
-        }
-        else
-        {
-            isNegative = false;
-        }
-        unsigned long long len = (NUMBER_LENGTH(value) / NUMBER_LENGTH(module)) + 1;
-        digits.resize(len);
-
-        unsigned long long mod = 0;
-        while (value != 0)
+        isNegative = value < 0;
+        // Модуль через unsigned: -LLONG_MIN в long long не помещается
+        unsigned long long rest = isNegative ? 0ULL - (unsigned long long)value : (unsigned long long)value;
+        while (rest != 0)
         {
-            mod = value % module;
-            digits[--len] = mod;
-            value /= module;
+            digits.insert(digits.begin(), rest % module);
+            rest /= module;
         }
     }
     BigInt(const std::string &str, unsigned long long _module = 1000000000)
     {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::parse_decimal, str.size() / 9 + 1);
         module = _module;
         int i = 0;
         isNegative = false;
@@ -85,11 +141,11 @@ public:
         }
         std::reverse(digits.begin(), digits.end());
     }
-    BigInt(const BigInt &other)
+    // Разряды не копируются: буфер общий до первой записи
+    BigInt(const BigInt &other) : digits(other.digits)
     {
         this->module = other.module;
         isNegative = other.isNegative;
-        digits.assign(other.digits.begin(), other.digits.end());
     }
 
 
@@ -97,7 +153,7 @@ public:
     {
         this->module = other.module;
         isNegative = other.isNegative;
-        digits.assign(other.digits.begin(), other.digits.end());
+        digits = std::move(other.digits);
 
         other.digits.clear();
     }
@@ -108,14 +164,18 @@ public:
     {
         this->module = other.module;
         isNegative = other.isNegative;
-        digits.assign(other.digits.begin(), other.digits.end());
+        digits = other.digits;
         return *this;
     }
     BigInt &operator=(BigInt &&other) noexcept
     {
+        if (this == &other)
+        {
+            return *this;
+        }
         this->module = other.module;
         isNegative = other.isNegative;
-        digits.assign(other.digits.begin(), other.digits.end());
+        digits.swap(other.digits);
 
         other.digits.clear();
         return *this;
@@ -140,41 +200,9 @@ public:
         }
         else
         {
-            BigInt first = (*this);
-            BigInt second = other;
-
-            unsigned long long div = 0, sum = 0;
-            BigInt result;
-            result.digits.clear();
-
-            if (first.digits.size() < second.digits.size())
-            {
-                swap(first, second);
-            }
-
-            for (int i = (int)(first.digits.size() - 1), j = (int)(second.digits.size() - 1); i >= 0; i--, j--)
-            {
-                if (j < 0)
-                {
-                    sum = first.digits[i] + div;
-                    result.digits.push_back(sum % module);
-                    div = sum / module;
-                    continue;
-                }
-                sum = first.digits[i] + second.digits[j] + div;
-                result.digits.push_back(sum % module);
-                div = sum / module;
-            }
-            if (div != 0)
-            {
-                result.digits.push_back(div % module);
-            }
-            if (first.isNegative)
-            {
-                result.isNegative = true;
-            }
-            take_zeroes_from_end_ans_reverse(result.digits);
-            return result;
+            // Модули складываются прямо из буферов операндов, без их копий
+            BIGINT_TELEMETRY_SCOPE(TelemetryOp::add, digits.size() + other.digits.size());
+            return from_magnitude(add_magnitude(magnitude(), other.magnitude()), isNegative);
         }
     }
     BigInt operator-(const BigInt &other) const
@@ -206,98 +234,34 @@ public:
         }
         else
         {
-            BigInt first = (*this), second = other;
-            if (first == second)
+            BIGINT_TELEMETRY_SCOPE(TelemetryOp::sub, digits.size() + other.digits.size());
+            const int cmp = compare_magnitude(magnitude(), other.magnitude());
+            if (cmp == 0)
             {
                 return BigInt(0);
             }
-            else
-            {
-                BigInt result;
-                if (first < second)
-                {
-                    swap(first, second);
-                    result.isNegative = true;
-                }
-
-                result.digits.clear();
-
-                for (int i = (int)(first.digits.size() - 1), j = (int)(second.digits.size() - 1); i >= 0; i--, j--)
-                {
-                    if (j < 0)
-                    {
-                        result.digits.push_back(first.digits[i]);
-                        continue;
-                    }
-                    int first_int = first.digits[i], second_int = second.digits[j];
-                    if (first_int < second_int)
-                    {
-                        take_dozen_for(first.digits, (size_t)i);
-                        first_int += module;
-                    }
-                    result.digits.push_back(first_int - second_int);
-                }
-                take_zeroes_from_end_ans_reverse(result.digits);
-                return result;
-            }
+            return cmp > 0 ? from_magnitude(sub_magnitude(magnitude(), other.magnitude()), false) : from_magnitude(sub_magnitude(other.magnitude(), magnitude()), true);
         }
     }
     BigInt operator*(const BigInt &other) const
     {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_schoolbook, digits.size() + other.digits.size());
+        const BigInt &first = digits.size() >= other.digits.size() ? *this : other;
+        const std::vector<unsigned long long> &second = (digits.size() >= other.digits.size() ? other : *this).magnitude();
 
-        bool negative = true;
-
-        if ((this->isNegative && other.isNegative) || (!this->isNegative && !other.isNegative))
-        {
-            negative = false;
-        }
-
-        BigInt result = 0, first = *this, second = other;
-        if (first < second)
-        {
-            swap(first, second);
-        }
-        std::vector<BigInt> numbers_to_sum;
-        for (int i = second.digits.size() - 1; i >= 0; i--)
-        {
-            BigInt num;
-            num.digits.clear();
-            for (size_t j = 0; j < second.digits.size() - i - 1; j++)
-            {
-                num.digits.push_back(0);
-            }
-
-            unsigned long long div = 0, res = 0;
-            for (int j = first.digits.size() - 1; j >= 0; j--)
-            {
-                res = second.digits[i] * first.digits[j] + div;
-
-                num.digits.push_back(res % module);
-
-                div = res / module;
-            }
-            if (div != 0)
-            {
-                num.digits.push_back(div % module);
-            }
-
-            std::reverse(num.digits.begin(), num.digits.end());
-            numbers_to_sum.push_back(num);
-        }
-
-        for (size_t i = 0; i < numbers_to_sum.size(); i++)
-        {
-            result = result + numbers_to_sum[i];
-        }
-        if (negative)
+        // Частичные произведения складываются без нормализации, перенос - один раз в конце
+        Accumulator numbers_to_sum;
+        for (size_t i = 0; i < second.size(); i++)
         {
-            result.isNegative = true;
+            numbers_to_sum.add_product(first, second[second.size() - 1 - i], i);
         }
-        return result;
+        BigInt result = numbers_to_sum.finalize();
+        return from_magnitude(result.magnitude(), isNegative != other.isNegative);
     }
 
     BigInt operator/(const BigInt &other) const
     {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::div_legacy, digits.size() + other.digits.size());
 
         if (other.digits[0] == 0)
         {
@@ -398,58 +362,126 @@ public:
         }
     }
 
-    BigInt operator*(const /* long  */ double &other) const
+    // Произведение на число с плавающей точкой, см. scale
+    BigInt operator*(double factor) const
+    {
+        return scale(factor);
+    }
+
+    // Точное произведение *this * factor, округлённое к ближайшему целому (половина - к чётному).
+    // factor = mantissa * 2^shift раскладывается точно: умножение на мантиссу и двоичный сдвиг,
+    // без перевода в строку и без погрешности double
+    BigInt scale(double factor) const
     {
-        if (other < __LDBL_EPSILON__)
+        if (!std::isfinite(factor))
         {
             throw std::exception();
         }
-        BigInt a = *this, result;
-        bool flag = false;
-        if (int(a.digits[0] * other) == 0 && a.digits.size() > 1)
+        if (factor == 0 || is_zero())
+        {
+            return BigInt(0);
+        }
+        int exp;
+        unsigned long long mantissa = (unsigned long long)std::ldexp(std::frexp(std::fabs(factor), &exp), DOUBLE_MANTISSA_BITS);
+        long long shift = (long long)exp - DOUBLE_MANTISSA_BITS;
+        const int zeros = std::countr_zero(mantissa);
+        mantissa >>= zeros;
+        shift += zeros;
+
+        std::vector<unsigned long long> mag = mantissa < DEFAULT_MODULE ? mul_1(magnitude(), mantissa) : mul_magnitude(magnitude(), small_magnitude(mantissa));
+        mag = shift >= 0 ? shift_bits_left(std::move(mag), (unsigned long long)shift) : shift_bits_right_rounded(mag, (unsigned long long)-shift);
+        return from_magnitude(std::move(mag), is_negative() != (factor < 0));
+    }
+
+    // Ближайшее double (половина - к чётной мантиссе); за пределами диапазона - бесконечность
+    double to_double() const
+    {
+        const std::vector<unsigned long long> &mag = magnitude();
+        double result;
+        if (mag.size() <= 2)
+        {
+            // Меньше 10^18 < 2^64: преобразование целого в double уже округляет к ближайшему
+            result = (double)(mag.size() == 2 ? mag[0] * DEFAULT_MODULE + mag[1] : mag[0]);
+        }
+        else if (mag.size() > DOUBLE_MAX_LIMBS)
         {
-            flag = true;
-            a.digits[1] = a.digits[0] * module + a.digits[1];
+            result = HUGE_VAL;
         }
-        for (size_t i = (flag ? 1 : 0); i < a.digits.size(); i++)
+        else
         {
-            if (a.digits[i] != 0)
+            const std::vector<uint32_t> words = to_binary_words(mag);
+            size_t bits = words.size() * 32;
+            while (bits > 0 && !((words[(bits - 1) / 32] >> ((bits - 1) % 32)) & 1))
             {
-                result.digits.push_back(a.digits[i] * other);
+                --bits;
             }
-            else
+            auto bit = [&words](size_t i) -> unsigned long long
+            {
+                return (words[i / 32] >> (i % 32)) & 1;
+            };
+
+            // Старшие 64 бита и признак ненулевых битов ниже них
+            const size_t low = bits > 64 ? bits - 64 : 0;
+            unsigned long long top = 0;
+            for (size_t i = bits; i-- > low;)
+            {
+                top = (top << 1) | bit(i);
+            }
+            bool sticky = false;
+            for (size_t i = 0; i < low && !sticky; i++)
             {
-                result.digits.push_back((unsigned long long)((module * 10) * other) % module);
+                sticky = bit(i) != 0;
             }
+
+            const int width = std::bit_width(top);
+            int drop = width > DOUBLE_MANTISSA_BITS ? width - DOUBLE_MANTISSA_BITS : 0;
+            if (drop > 0)
+            {
+                const unsigned long long rest = top & ((1ULL << drop) - 1), half = 1ULL << (drop - 1);
+                top >>= drop;
+                if (rest > half || (rest == half && (sticky || (top & 1))))
+                {
+                    ++top;
+                }
+            }
+            result = std::ldexp((double)top, (int)low + drop);
         }
-        return BigInt(to_string(result));
+        return is_negative() ? -result : result;
     }
 
-    BigInt operator<<(const BigInt &other)
+    // Целая часть value (с отбрасыванием дробной, как static_cast к целому), без потери точности
+    static BigInt from_double(double value)
     {
-        if (this->digits[0] == 0)
-        {
-            return BigInt(1);
-        }
-        BigInt first = *this;
-        for (BigInt i = 0; i < other; i++)
+        if (!std::isfinite(value))
         {
-            first *= 2;
+            throw std::exception();
         }
-        return first;
+        int exp;
+        const double fraction = std::frexp(std::fabs(std::trunc(value)), &exp);
+        const unsigned long long mantissa = (unsigned long long)std::ldexp(fraction, DOUBLE_MANTISSA_BITS);
+        const int shift = exp - DOUBLE_MANTISSA_BITS;
+        std::vector<unsigned long long> mag = shift >= 0 ? shift_bits_left(small_magnitude(mantissa), (unsigned long long)shift) : small_magnitude(mantissa >> -shift);
+        return from_magnitude(std::move(mag), value < 0);
+    }
+
+    BigInt operator<<(const BigInt &other) const
+    {
+        return from_magnitude(shift_bits_left(magnitude(), shift_count(other)), is_negative());
     }
 
-    BigInt operator>>(const BigInt &other)
+    // Сдвиг вправо - деление на 2^count с отбрасыванием дробной части (к нулю)
+    BigInt operator>>(const BigInt &other) const
     {
-        BigInt first = *this;
-        for (BigInt i = 0; i < other; i++)
+        unsigned long long count = shift_count(other), rem = 0;
+        std::vector<unsigned long long> mag = magnitude();
+        for (; count >= 29 && !is_zero_magnitude(mag); count -= 29)
         {
-            first /= 2;
+            mag = divrem_1(mag, Reciprocal(1ULL << 29), rem);
         }
-        return first;
+        return from_magnitude(divrem_1(mag, Reciprocal(1ULL << (count >= 29 ? 0 : count)), rem), is_negative());
     }
 
-    BigInt operator%(const BigInt &other)
+    BigInt operator%(const BigInt &other) const
     {
         BigInt first = *this / other;
         BigInt second = first * other;
@@ -499,43 +531,140 @@ public:
 
     BigInt &operator++()
     {
-        (*this) = (*this) + BigInt(1);
+        (*this) += 1;
         return (*this);
     }
 
     BigInt operator++(int)
     {
         BigInt result = *this;
-        (*this) = (*this) + BigInt(1);
+        (*this) += 1;
         return result;
     }
     BigInt &operator--()
     {
-        (*this) = (*this) - BigInt(1);
+        (*this) -= 1;
         return (*this);
     }
 
     BigInt operator--(int)
     {
         BigInt result = *this;
-        (*this) = (*this) - BigInt(1);
+        (*this) -= 1;
         return result;
     }
 
-    bool operator==(const BigInt &other) const
+    // Операции с машинными целыми идут через однословные ядра без построения BigInt
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt operator+(T value) const
+    {
+        return add_small(value < 0, small_abs(value));
+    }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt operator-(T value) const
+    {
+        return add_small(value > 0, small_abs(value));
+    }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt operator*(T value) const
+    {
+        const unsigned long long m = small_abs(value);
+        std::vector<unsigned long long> mag = m < DEFAULT_MODULE ? mul_1(magnitude(), m) : mul_magnitude(magnitude(), small_magnitude(m));
+        return from_magnitude(std::move(mag), is_negative() != (value < 0));
+    }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt operator/(T value) const
+    {
+        unsigned long long rem = 0;
+        return from_magnitude(divrem_small(small_abs(value), rem), is_negative() != (value < 0));
+    }
+
+    // Остаток берёт знак делимого, как и operator%(const BigInt &)
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt operator%(T value) const
     {
-        if ((other.digits.size() != this->digits.size()) || (other.isNegative != this->isNegative))
+        const unsigned long long d = small_abs(value);
+        if (d == 0)
         {
-            return false;
+            throw std::exception();
         }
-        for (size_t i = 0; i < other.digits.size(); i++)
+        if (d < DEFAULT_MODULE)
         {
-            if (this->digits[i] != other.digits[i])
-            {
-                return false;
-            }
+            return from_magnitude({mod_1(magnitude(), Reciprocal(d))}, is_negative());
         }
-        return true;
+        std::vector<unsigned long long> rem;
+        divmod_magnitude(magnitude(), small_magnitude(d), rem);
+        return from_magnitude(std::move(rem), is_negative());
+    }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt &operator+=(T value)
+    {
+        return *this = *this + value;
+    }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt &operator-=(T value)
+    {
+        return *this = *this - value;
+    }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt &operator*=(T value)
+    {
+        return *this = *this * value;
+    }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt &operator/=(T value)
+    {
+        return *this = *this / value;
+    }
+
+    template <std::integral T>
+        requires(!std::same_as<T, bool>)
+    BigInt &operator%=(T value)
+    {
+        return *this = *this % value;
+    }
+
+    bool is_zero() const
+    {
+        return magnitude().size() == 1 && magnitude()[0] == 0;
+    }
+
+    // module чётный, поэтому чётность числа - это чётность младшего разряда
+    bool is_even() const
+    {
+        return magnitude().back() % 2 == 0;
+    }
+
+    bool is_odd() const
+    {
+        return !is_even();
+    }
+
+    int sign() const
+    {
+        return is_zero() ? 0 : (isNegative ? -1 : 1);
+    }
+
+    bool operator==(const BigInt &other) const
+    {
+        const std::vector<unsigned long long> &a = magnitude(), &b = other.magnitude();
+        return a.size() == b.size() && is_negative() == other.is_negative() && std::equal(a.begin(), a.end(), b.begin());
     }
 
     bool operator!=(const BigInt &other) const
@@ -543,85 +672,31 @@ public:
         return !(*this == other);
     }
 
-    bool operator<(const BigInt &other) const
+    // Сравнение за один проход: знак, длина, затем разряды
+    std::strong_ordering operator<=>(const BigInt &other) const
     {
-        if (this->isNegative < other.isNegative)
-        {
-            return false;
-        }
-        else if (other.isNegative < this->isNegative)
+        const bool negative = is_negative();
+        if (negative != other.is_negative())
         {
-            return true;
+            return negative ? std::strong_ordering::less : std::strong_ordering::greater;
         }
-        else
+        int cmp = compare_magnitude(magnitude(), other.magnitude());
+        if (negative)
         {
-            if (this->isNegative)
-            {
-                if (this->digits.size() > other.digits.size())
-                {
-                    return true;
-                }
-                else if (this->digits.size() < other.digits.size())
-                {
-                    return false;
-                }
-                else
-                {
-                    for (size_t i = 0; i < this->digits.size(); i++)
-                    {
-                        if (this->digits[i] > other.digits[i])
-                        {
-                            return true;
-                        }
-                        else if (this->digits[i] < other.digits[i])
-                        {
-                            return false;
-                        }
-                    }
-                    return false;
-                }
-            }
-            else
-            {
-                if (this->digits.size() > other.digits.size())
-                {
-                    return false;
-                }
-                else if (this->digits.size() < other.digits.size())
-                {
-                    return true;
-                }
-                else
-                {
-                    for (size_t i = 0; i < this->digits.size(); i++)
-                    {
-                        if (this->digits[i] > other.digits[i])
-                        {
-                            return false;
-                        }
-                        else if (this->digits[i] < other.digits[i])
-                        {
-                            return true;
-                        }
-                    }
-                    return false;
-                }
-            }
+            cmp = -cmp;
         }
+        return cmp < 0 ? std::strong_ordering::less : (cmp > 0 ? std::strong_ordering::greater : std::strong_ordering::equal);
     }
 
-    bool operator>=(const BigInt &other) const
-    {
-        return !((*this) < other);
-    }
-
-    bool operator>(const BigInt &other) const
-    {
-        return !((*this) <= other);
-    }
-    bool operator<=(const BigInt &other) const
+    size_t hash() const
     {
-        return ((*this) < other) || ((*this) == other);
+        const std::vector<unsigned long long> &mag = magnitude();
+        size_t result = is_negative() ? 0x9e3779b97f4a7c15ULL : 0;
+        for (unsigned long long limb : mag)
+        {
+            result ^= std::hash<unsigned long long>()(limb) + 0x9e3779b97f4a7c15ULL + (result << 6) + (result >> 2);
+        }
+        return result;
     }
 
     static void swap(BigInt &first, BigInt &second)
@@ -630,47 +705,104 @@ public:
         std::swap(first.digits, second.digits);
     }
 
+    // Потоковое чтение: цифры сразу собираются в разряды по 9 слева направо, без копии строки.
+    // Длина заранее неизвестна, поэтому выравнивание разрядов по правому краю делается в конце
     friend std::istream &operator>>(std::istream &is, BigInt &num)
     {
-        std::string number;
-        is >> number;
-        num = BigInt(number);
+        std::istream::sentry sentry(is);
+        if (!sentry)
+        {
+            return is;
+        }
+        std::streambuf *buf = is.rdbuf();
+        using traits = std::istream::traits_type;
+
+        bool negative = false;
+        if (buf->sgetc() == '-')
+        {
+            negative = true;
+            buf->sbumpc();
+        }
+
+        std::vector<unsigned long long> limbs;
+        unsigned long long limb = 0;
+        size_t limb_digits = 0, total_digits = 0;
+        int c = buf->sgetc();
+        for (; !traits::eq_int_type(c, traits::eof()) && !std::isspace(c); c = buf->snextc())
+        {
+            if (c < '0' || c > '9')
+            {
+                throw std::exception();
+            }
+            limb = limb * 10 + (c - '0');
+            ++total_digits;
+            if (++limb_digits == 9)
+            {
+                limbs.push_back(limb);
+                limb = 0;
+                limb_digits = 0;
+            }
+        }
+        if (traits::eq_int_type(c, traits::eof()))
+        {
+            is.setstate(std::ios::eofbit);
+        }
+        if (total_digits == 0)
+        {
+            is.setstate(std::ios::failbit);
+            return is;
+        }
+
+        // limbs * 10^limb_digits + limb: сдвиг на месте, справа налево
+        if (limb_digits != 0)
+        {
+            unsigned long long scale = 1;
+            for (size_t i = 0; i < limb_digits; i++)
+            {
+                scale *= 10;
+            }
+            unsigned long long carry = limb;
+            for (size_t i = limbs.size(); i-- > 0;)
+            {
+                unsigned long long cur = limbs[i] * scale + carry;
+                limbs[i] = cur % DEFAULT_MODULE;
+                carry = cur / DEFAULT_MODULE;
+            }
+            limbs.insert(limbs.begin(), carry);
+        }
+        num = from_magnitude(std::move(limbs), negative);
         return is;
     }
 
+    // Запись блоками через буфер фиксированного размера, без промежуточной строки на всё число
     friend std::ostream &operator<<(std::ostream &os, const BigInt &num)
     {
-        if (num.digits.front() == 0)
-        {
-            os << '0';
-            return os;
-        }
-        if (num.isNegative)
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::print_decimal, num.digits.size());
+        const std::vector<unsigned long long> &limbs = num.magnitude();
+        const size_t width = NUMBER_LENGTH(num.module) - 1;
+        char buffer[STREAM_CHUNK];
+        size_t used = 0;
+
+        if (num.is_negative())
         {
-            os << "-";
+            buffer[used++] = '-';
         }
-        os << num.digits[0];
-        for (size_t i = 1; i < num.digits.size(); i++)
+        used = std::to_chars(buffer + used, buffer + STREAM_CHUNK, limbs[0]).ptr - buffer;
+        for (size_t i = 1; i < limbs.size(); i++)
         {
-            if (num.digits[i] == 0)
+            if (used + width > STREAM_CHUNK)
             {
-                for (unsigned long long j = 1; j < num.module; j *= 10)
-                {
-                    os << '0';
-                }
-                continue;
+                os.write(buffer, (std::streamsize)used);
+                used = 0;
             }
-            else
+            unsigned long long limb = limbs[i];
+            for (size_t j = width; j-- > 0; limb /= 10)
             {
-                int j = NUMBER_LENGTH(num.digits[i]);
-                int mod_length = NUMBER_LENGTH(num.module) - 1;
-                while (j++ < mod_length)
-                {
-                    os << '0';
-                }
-                os << num.digits[i];
+                buffer[used + j] = (char)('0' + limb % 10);
             }
+            used += width;
         }
+        os.write(buffer, (std::streamsize)used);
         return os;
     }
 
@@ -686,249 +818,3362 @@ public:
             return BigInt(1);
         }
 
+        if (!base.isNegative && !exp.isNegative && MontgomeryContext::is_suitable(mod))
+        {
+            return MontgomeryContext(mod).pow(base, exp);
+        }
+
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mod_exp_generic, mod.digits.size());
         BigInt res = 1, n = exp, x = base; // res = x ^ n;
 
         bool negative = false;
-        if (x.isNegative && (n % BigInt(2) == BigInt(1)))
+        if (x.isNegative && n.is_odd())
         {
             negative = true;
         }
 
-        while (n != BigInt(0))
+        while (!n.is_zero())
         {
-            if (n.digits.back() % 2 == 1)
+            progress_point(1.0 - (double)n.magnitude().size() / (double)exp.magnitude().size());
+            if (n.is_odd())
             {
                 res = (mod.digits.front() == 0) ? res * x : (res * x) % mod;
             }
-            x *= x;
-            n >>= 1;
+            x = (mod.digits.front() == 0) ? x * x : (x * x) % mod;
+            n /= 2;
         }
-        return negative ? res * BigInt("-1") : res;
+        return negative ? res * -1 : res;
     }
 
-    BigInt fft_multiply(const BigInt &a) const
+    // Исключение, которым прерывается асинхронное вычисление после запроса остановки
+    class Cancelled : public std::exception
     {
-        BigInt _this(to_string(*this), 1000), other(to_string(a), 1000);
-        
-        BigInt result;
-        result.module = 1000;
-
-        std::vector<std::complex<long double>> fa(_this.digits.begin(), _this.digits.end()), fb(other.digits.begin(), other.digits.end());
-        size_t n = 1;
-
-        while (n < std::max(_this.digits.size(), other.digits.size()))
+    public:
+        const char *what() const noexcept override
         {
-            n <<= 1;
+            return "BigInt: computation cancelled";
         }
-        n <<= 1;
+    };
 
-        fa.insert(fa.begin(), (int)(n - fa.size()), std::complex<long double>(0, 0));
-        fb.insert(fb.begin(), (int)(n - fb.size()), std::complex<long double>(0, 0));
+    // Получает долю выполненной работы в [0, 1]; вызывается из потока, где идёт вычисление
+    using ProgressCallback = std::function<void(double)>;
 
-        const long double ang = (2.0 * PI) / (long double)(n);
-        
-        const std::complex<long double> w(std::cos(ang), std::sin(ang));
-        std::complex<long double> wn(1, 0);
+    // Асинхронные варианты долгих операций. Вычисление идёт в отдельном потоке или на переданном
+    // исполнителе (любой вызываемый объект, принимающий std::function<void()>), между уровнями
+    // рекурсии и проходами БПФ проверяет stop и сообщает прогресс. После запроса остановки
+    // future завершается исключением Cancelled. Операнды копируются - при общем буфере это O(1)
+    std::future<BigInt> multiply_async(const BigInt &other, std::stop_token stop = {}, ProgressCallback progress = {}) const
+    {
+        return std::async(std::launch::async, controlled(multiply_work(other), std::move(stop), std::move(progress)));
+    }
 
-        fft(fa, w);
-        fft(fb, w);
+    template <typename Executor>
+        requires std::invocable<Executor &, std::function<void()>>
+    std::future<BigInt> multiply_async(Executor &executor, const BigInt &other, std::stop_token stop = {}, ProgressCallback progress = {}) const
+    {
+        return launch(executor, controlled(multiply_work(other), std::move(stop), std::move(progress)));
+    }
 
-        for (size_t i = 0; i < n; ++i)
-        {
-            fa[i] *= fb[i];
-        }
+    // Частное с округлением к нулю, как у operator/, через обратное по Ньютону
+    std::future<BigInt> divide_async(const BigInt &other, std::stop_token stop = {}, ProgressCallback progress = {}) const
+    {
+        return std::async(std::launch::async, controlled(divide_work(other), std::move(stop), std::move(progress)));
+    }
 
-        fft(fa, wn / w);
+    template <typename Executor>
+        requires std::invocable<Executor &, std::function<void()>>
+    std::future<BigInt> divide_async(Executor &executor, const BigInt &other, std::stop_token stop = {}, ProgressCallback progress = {}) const
+    {
+        return launch(executor, controlled(divide_work(other), std::move(stop), std::move(progress)));
+    }
 
-        for (size_t i = 0; i < n; i++)
-        {
-            result.digits.push_back((unsigned long long)std::round(fa[i].real() / (long double)n));
-        }
+    std::future<BigInt> mod_exp_async(const BigInt &exp, const BigInt &mod, std::stop_token stop = {}, ProgressCallback progress = {}) const
+    {
+        return std::async(std::launch::async, controlled(mod_exp_work(exp, mod), std::move(stop), std::move(progress)));
+    }
 
-        while (result.digits.size() > 1 && result.digits.front() == 0)
-        {
-            result.digits.erase(result.digits.begin());
-        }
-        
+    template <typename Executor>
+        requires std::invocable<Executor &, std::function<void()>>
+    std::future<BigInt> mod_exp_async(Executor &executor, const BigInt &exp, const BigInt &mod, std::stop_token stop = {}, ProgressCallback progress = {}) const
+    {
+        return launch(executor, controlled(mod_exp_work(exp, mod), std::move(stop), std::move(progress)));
+    }
 
-        
-        std::vector<unsigned long long> r_v;
-        module_digits(result.digits, r_v, result.module);
-        result.digits = r_v;
-        result.isNegative = this->isNegative != a.isNegative;
-        std::string ans = to_string(result);
+    // Телеметрия: число вызовов, обработанных разрядов, выделений памяти и время по каждой операции
+    // и алгоритму. Включается макросом BIGINT_TELEMETRY (опция CMake BIGINT_TELEMETRY); без него
+    // точки замера не компилируются, а снимок всегда пуст. У каждого потока свои счётчики, снимок
+    // складывает их. Время и выделения включают вложенные вызовы: Карацуба учитывает и свои
+    // подпроизведения, которые при этом считаются и под своим алгоритмом
+    enum class TelemetryOp : uint8_t
+    {
+        add,
+        sub,
+        mul_schoolbook,
+        mul_karatsuba,
+        mul_toom32,
+        mul_sliced,
+        mul_fft,
+        mul_truncated,
+        div_legacy,
+        div_knuth,
+        div_newton,
+        div_barrett,
+        mod_exp_montgomery,
+        mod_exp_generic,
+        parse_decimal,
+        parse_radix,
+        print_decimal,
+        print_radix,
+        gcd,
+        xgcd,
+        count
+    };
 
-        return BigInt(ans);
-    }
+#ifdef BIGINT_TELEMETRY
+    static constexpr bool TELEMETRY_ENABLED = true;
+#else
+    static constexpr bool TELEMETRY_ENABLED = false;
+#endif
 
-    BigInt karatsuba_multiply(const BigInt &element) const
+    struct TelemetryCounters
     {
-        BigInt a = *this, b = element, result;
-        result.isNegative = (a.isNegative != b.isNegative);
+        uint64_t calls = 0, limbs = 0, allocations = 0, nanoseconds = 0;
+    };
 
-        if (a.digits.size() < 2 || b.digits.size() < 2)
+    class TelemetrySnapshot
+    {
+    public:
+        const TelemetryCounters &operator[](TelemetryOp op) const
+        {
+            return _counters[(size_t)op];
+        }
+
+        // Операция и алгоритм - метки operation и tier в выводе Prometheus
+        static std::pair<const char *, const char *> labels(TelemetryOp op)
+        {
+            static constexpr std::pair<const char *, const char *> names[] = {
+                {"add", "linear"}, {"sub", "linear"},
+                {"mul", "schoolbook"}, {"mul", "karatsuba"}, {"mul", "toom32"}, {"mul", "sliced"}, {"mul", "fft"}, {"mul", "truncated"},
+                {"div", "legacy"}, {"div", "knuth"}, {"div", "newton"}, {"div", "barrett"},
+                {"mod_exp", "montgomery"}, {"mod_exp", "generic"},
+                {"parse", "decimal"}, {"parse", "radix"}, {"print", "decimal"}, {"print", "radix"},
+                {"gcd", "plain"}, {"gcd", "extended"}};
+            static_assert(std::size(names) == (size_t)TelemetryOp::count);
+            return names[(size_t)op];
+        }
+
+        // Текстовый формат Prometheus: четыре счётчика с метками operation и tier, время - в секундах
+        std::string prometheus() const
+        {
+            struct Metric
+            {
+                const char *name, *help;
+                uint64_t TelemetryCounters::*field;
+            };
+            static constexpr Metric metrics[] = {
+                {"bigint_calls_total", "Calls per BigInt operation and algorithm tier.", &TelemetryCounters::calls},
+                {"bigint_limbs_total", "Operand limbs (base 10^9) processed.", &TelemetryCounters::limbs},
+                {"bigint_allocations_total", "Heap allocations made inside the operation.", &TelemetryCounters::allocations},
+                {"bigint_seconds_total", "Wall time spent inside the operation.", &TelemetryCounters::nanoseconds}};
+
+            std::string out;
+            for (const Metric &metric : metrics)
+            {
+                out += std::string("# HELP ") + metric.name + " " + metric.help + "\n# TYPE " + metric.name + " counter\n";
+                for (size_t i = 0; i < _counters.size(); i++)
+                {
+                    const auto [operation, tier] = labels((TelemetryOp)i);
+                    const uint64_t value = _counters[i].*metric.field;
+                    char number[32];
+                    char *end = metric.field == &TelemetryCounters::nanoseconds ? std::to_chars(number, number + sizeof(number), (double)value / 1e9).ptr
+                                                                                 : std::to_chars(number, number + sizeof(number), value).ptr;
+                    out += std::string(metric.name) + "{operation=\"" + operation + "\",tier=\"" + tier + "\"} " + std::string(number, end) + "\n";
+                }
+            }
+            return out;
+        }
+
+    private:
+        friend class BigInt;
+
+        std::array<TelemetryCounters, (size_t)TelemetryOp::count> _counters{};
+    };
+
+    // Сумма счётчиков всех потоков, включая завершившиеся
+    static TelemetrySnapshot telemetry_snapshot()
+    {
+        TelemetrySnapshot snapshot;
+#ifdef BIGINT_TELEMETRY
+        TelemetryRegistry &registry = telemetry_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        snapshot = registry.retired;
+        for (const TelemetryThread *thread : registry.threads)
+        {
+            thread->add_to(snapshot);
+        }
+#endif
+        return snapshot;
+    }
+
+    // Обнуление; замеры, идущие в этот момент в других потоках, могут частично остаться
+    static void telemetry_reset()
+    {
+#ifdef BIGINT_TELEMETRY
+        TelemetryRegistry &registry = telemetry_registry();
+        std::lock_guard<std::mutex> lock(registry.mutex);
+        registry.retired = TelemetrySnapshot();
+        for (TelemetryThread *thread : registry.threads)
+        {
+            thread->reset();
+        }
+#endif
+    }
+
+    // Вызывается из замены operator new (BIGINT_TELEMETRY_ALLOCATION_HOOKS)
+    static void telemetry_note_allocation() noexcept
+    {
+#ifdef BIGINT_TELEMETRY
+        ++telemetry_allocations;
+#endif
+    }
+
+    // Длинный множитель режется на куски длины короткого, спектр короткого считается один раз
+    BigInt fft_multiply(const BigInt &a) const
+    {
+        const std::vector<unsigned long long> &x = magnitude(), &y = a.magnitude();
+        const std::vector<unsigned long long> &longer = x.size() >= y.size() ? x : y;
+        const std::vector<unsigned long long> &shorter = x.size() >= y.size() ? y : x;
+        std::vector<unsigned long long> product;
+        if (longer.size() >= 2 * shorter.size())
+        {
+            product = sliced_mul_magnitude(longer, shorter, true);
+        }
+        else if (fft_fits(longer.size(), shorter.size()))
+        {
+            product = fft_mul_magnitude(longer, fft_prepare(shorter, longer.size()));
+        }
+        else
+        {
+            product = fast_mul_magnitude(longer, shorter);
+        }
+        return from_magnitude(std::move(product), is_negative() != a.is_negative());
+    }
+
+    // Деление пополам идёт по длинному множителю; при сильной разнице длин - нарезка или Toom-2.5
+    BigInt karatsuba_multiply(const BigInt &element) const
+    {
+        if (&magnitude() == &element.magnitude())
+        {
+            return square();
+        }
+        return from_magnitude(fast_mul_magnitude(magnitude(), element.magnitude()), is_negative() != element.is_negative());
+    }
+
+    // Квадрат числа; в полтора-два раза быстрее умножения на себя
+    BigInt square() const
+    {
+        return from_magnitude(sqr_magnitude(magnitude()), false);
+    }
+
+    // Младшие n разрядов (по основанию module) модуля произведения, знак - как у произведения
+    BigInt mul_low(const BigInt &other, size_t n) const
+    {
+        return from_magnitude(mul_low_magnitude(magnitude(), other.magnitude(), n), is_negative() != other.is_negative());
+    }
+
+    // floor(|a * b| / module^n) со знаком произведения; может оказаться меньше точного на единицу
+    BigInt mul_high(const BigInt &other, size_t n) const
+    {
+        return from_magnitude(mul_high_magnitude(magnitude(), other.magnitude(), n), is_negative() != other.is_negative());
+    }
+
+    // Разряды [lo, hi) модуля произведения; младший из них - с той же погрешностью, что у mul_high
+    BigInt mul_middle(const BigInt &other, size_t lo, size_t hi) const
+    {
+        return from_magnitude(mul_middle_magnitude(magnitude(), other.magnitude(), lo, hi), is_negative() != other.is_negative());
+    }
+
+    BigInt newton_divide(const BigInt &a) const
+    {
+        if (a.is_zero())
+        {
+            throw std::exception();
+        }
+        return from_magnitude(newton_divide_mas(magnitude(), a.magnitude()).first, is_negative() != a.is_negative());
+    }
+
+    // Частное и остаток модулей через обратное floor(module^|f| / g): частное - старшая часть f * h,
+    // остаток - младшие |g| + 1 разрядов f - q * g, так что оба произведения усечённые
+    static std::pair<std::vector<unsigned long long>, std::vector<unsigned long long>> newton_divide_mas(const std::vector<unsigned long long> &f, const std::vector<unsigned long long> &g)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::div_newton, f.size() + g.size());
+        if (compare_magnitude(f, g) < 0)
+        {
+            return {std::vector<unsigned long long>(1, 0), std::vector<unsigned long long>(f)};
+        }
+        const size_t n = g.size();
+        ProgressSteps steps(4);
+        steps.next(2);
+        std::vector<unsigned long long> h = newton_inverse(g, (int)(f.size() - n + 1));
+        steps.next();
+        std::vector<unsigned long long> q = mul_high_magnitude(f, h, f.size());
+        steps.next();
+        std::vector<unsigned long long> f_low = low_limbs(f, n + 1), qg_low = mul_low_magnitude(q, g, n + 1);
+        std::vector<unsigned long long> r = compare_magnitude(f_low, qg_low) >= 0 ? sub_magnitude(f_low, qg_low) : sub_magnitude(add_magnitude(f_low, shift_magnitude({1}, n + 1)), qg_low);
+        while (compare_magnitude(r, g) >= 0)
+        {
+            r = sub_magnitude(r, g);
+            q = add_magnitude(q, {1});
+        }
+        return {q, r};
+    }
+
+    static std::vector<unsigned long long> rev(const std::vector<unsigned long long> &vec, size_t n)
+    {
+        std::vector<unsigned long long> result = vec;
+
+        size_t elements_to_reverse = std::min(n, result.size());
+
+        std::reverse(result.begin(), result.begin() + elements_to_reverse);
+
+        return result;
+    }
+
+    // floor(module^(|f| + l - 1) / f) - обратное с l разрядами сверх длины f
+    static std::vector<unsigned long long> newton_inverse(std::vector<unsigned long long> f, int l)
+    {
+        trim_magnitude(f);
+        if (is_zero_magnitude(f) || l < 1)
+        {
+            throw std::exception();
+        }
+        return inverse_magnitude(f, f.size() + (size_t)l - 1);
+    }
+
+    static unsigned long long mod_inv(unsigned long long a, unsigned long long module = 1000000000)
+    {
+        if (a == 0)
+        {
+            throw std::exception();
+        }
+        else if (a % 2 == 0 || a % 5 == 0)
+        {
+            a++;
+        }
+
+        // Используем расширенный алгоритм Евклида
+        long long m = module;
+        long long y = 0, x = 1;
+        long long original_m = m;
+
+        if (m == 1)
+        {
+            return 0;
+        }
+
+        while (a > 1)
+        {
+            long long q = a / m;
+            long long t = m;
+
+            m = a % m;
+            a = t;
+            t = y;
+
+            y = x - q * y;
+            x = t;
+        }
+
+        if (x < 0)
+        {
+            x += original_m;
+        }
+
+        return x;
+    }
+
+    static BigInt gcd(const BigInt &a, const BigInt &b)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::gcd, a.digits.size() + b.digits.size());
+        std::vector<unsigned long long> x = a.digits, y = b.digits;
+        trim_magnitude(x);
+        trim_magnitude(y);
+        if (compare_magnitude(x, y) < 0)
+        {
+            x.swap(y);
+        }
+        gcd_reduce(x, y, nullptr);
+        return from_magnitude(std::move(x), false);
+    }
+
+    // Возвращает g = gcd(a, b) >= 0 и коэффициенты x, y: a * x + b * y = g
+    static BigInt xgcd(const BigInt &a, const BigInt &b, BigInt &x, BigInt &y)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::xgcd, a.digits.size() + b.digits.size());
+        std::vector<unsigned long long> u = a.digits, v = b.digits;
+        trim_magnitude(u);
+        trim_magnitude(v);
+
+        GcdMatrix m;
+        if (compare_magnitude(u, v) < 0)
+        {
+            u.swap(v);
+            std::swap(m.at(0, 0), m.at(0, 1));
+            std::swap(m.at(1, 0), m.at(1, 1));
+        }
+        gcd_reduce(u, v, &m);
+
+        x = from_magnitude(m.at(0, 0).digits, m.at(0, 0).isNegative != a.isNegative);
+        y = from_magnitude(m.at(0, 1).digits, m.at(0, 1).isNegative != b.isNegative);
+        return from_magnitude(std::move(u), false);
+    }
+
+    // Обратный элемент по модулю mod > 0, если gcd(*this, mod) != 1 - исключение
+    BigInt mod_inverse(const BigInt &mod) const
+    {
+        std::vector<unsigned long long> m = mod.digits;
+        trim_magnitude(m);
+        if (mod.isNegative || (m.size() == 1 && m[0] == 0))
+        {
+            throw std::exception();
+        }
+
+        std::vector<unsigned long long> r, a = digits;
+        trim_magnitude(a);
+        divmod_magnitude(a, m, r);
+
+        BigInt x, y;
+        BigInt g = xgcd(from_magnitude(r, isNegative), mod, x, y);
+        if (g != BigInt(1))
+        {
+            throw std::exception();
+        }
+
+        std::vector<unsigned long long> x_mod;
+        divmod_magnitude(x.digits, m, x_mod);
+        if (x.isNegative && !(x_mod.size() == 1 && x_mod[0] == 0))
+        {
+            x_mod = sub_magnitude(m, x_mod);
+        }
+        return from_magnitude(std::move(x_mod), false);
+    }
+
+    // Целая часть квадратного корня, для отрицательных чисел - исключение
+    BigInt isqrt() const
+    {
+        return iroot(2);
+    }
+
+    // Целая часть корня степени k (для нечётных k у отрицательного числа корень отрицательный)
+    BigInt iroot(unsigned long long k) const
+    {
+        std::vector<unsigned long long> n = digits;
+        trim_magnitude(n);
+        if (k == 0 || (isNegative && k % 2 == 0 && !is_zero_magnitude(n)))
+        {
+            throw std::exception();
+        }
+        if (k == 1)
+        {
+            return from_magnitude(std::move(n), isNegative);
+        }
+        return from_magnitude(iroot_magnitude(n, k), isNegative);
+    }
+
+    bool is_perfect_square() const
+    {
+        std::vector<unsigned long long> n = digits;
+        trim_magnitude(n);
+        if (isNegative && !is_zero_magnitude(n))
+        {
+            return false;
+        }
+        if (!square_residue_filter(n))
+        {
+            return false;
+        }
+        std::vector<unsigned long long> root = iroot_magnitude(n, 2);
+        return compare_magnitude(sqr_magnitude(root), n) == 0;
+    }
+
+    // Сумматор с избыточными переносами: разряды (младший первым) хранятся в 64-битных словах
+    // без нормализации, поэтому сложение - поразрядный цикл без переносов. Переносы
+    // распространяются только при угрозе переполнения и в finalize()
+    class Accumulator
+    {
+    public:
+        void add(const BigInt &value, size_t shift = 0)
+        {
+            side(value.is_negative()).add(value.magnitude(), shift);
+        }
+
+        void sub(const BigInt &value, size_t shift = 0)
+        {
+            side(!value.is_negative()).add(value.magnitude(), shift);
+        }
+
+        // += value * m * module^shift
+        void add_product(const BigInt &value, unsigned long long m, size_t shift = 0)
+        {
+            Side &target = side(value.is_negative());
+            for (; m != 0; m /= DEFAULT_MODULE, ++shift)
+            {
+                target.add_product(value.magnitude(), m % DEFAULT_MODULE, shift);
+            }
+        }
+
+        Accumulator &operator+=(const Accumulator &other)
+        {
+            positive.merge(other.positive);
+            negative.merge(other.negative);
+            return *this;
+        }
+
+        BigInt finalize() const
+        {
+            std::vector<unsigned long long> pos = positive.normalized(), neg = negative.normalized();
+            if (compare_magnitude(pos, neg) >= 0)
+            {
+                return from_magnitude(sub_magnitude(pos, neg), false);
+            }
+            return from_magnitude(sub_magnitude(neg, pos), true);
+        }
+
+        // Слияние накопителей разных потоков попарно, уровни дерева сливаются параллельно
+        static Accumulator merge(std::vector<Accumulator> parts)
+        {
+            if (parts.empty())
+            {
+                return Accumulator();
+            }
+            while (parts.size() > 1)
+            {
+                std::vector<std::future<void>> tasks;
+                for (size_t i = 0; i + 1 < parts.size(); i += 2)
+                {
+                    tasks.push_back(std::async(std::launch::async, [&parts, i]()
+                                               { parts[i] += parts[i + 1]; }));
+                }
+                for (std::future<void> &task : tasks)
+                {
+                    task.get();
+                }
+                for (size_t i = 1; 2 * i < parts.size(); i++)
+                {
+                    parts[i] = std::move(parts[2 * i]);
+                }
+                parts.resize((parts.size() + 1) / 2);
+            }
+            return std::move(parts.front());
+        }
+
+    private:
+        // Слова ограничены LIMIT, чтобы нормализация сама не переполнялась
+        static constexpr unsigned long long LIMIT = 1ULL << 63;
+
+        struct Side
+        {
+            std::vector<unsigned long long> limbs; // младший первым
+            unsigned long long bound = 0;          // верхняя граница любого слова
+
+            void reserve(size_t size, unsigned long long grow)
+            {
+                if (bound > LIMIT - grow)
+                {
+                    normalize();
+                }
+                bound += grow;
+                if (limbs.size() < size)
+                {
+                    limbs.resize(size, 0);
+                }
+            }
+
+            void add(const std::vector<unsigned long long> &mag, size_t shift)
+            {
+                reserve(shift + mag.size(), DEFAULT_MODULE);
+                unsigned long long *out = limbs.data() + shift;
+                const size_t n = mag.size();
+                for (size_t i = 0; i < n; i++)
+                {
+                    out[i] += mag[n - 1 - i];
+                }
+            }
+
+            // Произведение разряда на m < module раскладывается на младшую и старшую части,
+            // каждое слово получает не больше 2 * module
+            void add_product(const std::vector<unsigned long long> &mag, unsigned long long m, size_t shift)
+            {
+                if (m == 0)
+                {
+                    return;
+                }
+                reserve(shift + mag.size() + 1, 2 * DEFAULT_MODULE);
+                unsigned long long *out = limbs.data() + shift;
+                const size_t n = mag.size();
+                for (size_t i = 0; i < n; i++)
+                {
+                    unsigned long long product = mag[n - 1 - i] * m;
+                    out[i] += product % DEFAULT_MODULE;
+                    out[i + 1] += product / DEFAULT_MODULE;
+                }
+            }
+
+            void merge(const Side &other)
+            {
+                if (other.limbs.empty())
+                {
+                    return;
+                }
+                if (other.bound > LIMIT / 2)
+                {
+                    Side copy = other;
+                    copy.normalize();
+                    merge(copy);
+                    return;
+                }
+                reserve(other.limbs.size(), other.bound);
+                for (size_t i = 0; i < other.limbs.size(); i++)
+                {
+                    limbs[i] += other.limbs[i];
+                }
+            }
+
+            void normalize()
+            {
+                unsigned long long carry = 0;
+                for (unsigned long long &limb : limbs)
+                {
+                    unsigned long long cur = limb + carry;
+                    limb = cur % DEFAULT_MODULE;
+                    carry = cur / DEFAULT_MODULE;
+                }
+                for (; carry != 0; carry /= DEFAULT_MODULE)
+                {
+                    limbs.push_back(carry % DEFAULT_MODULE);
+                }
+                bound = DEFAULT_MODULE - 1;
+            }
+
+            std::vector<unsigned long long> normalized() const
+            {
+                Side copy = *this;
+                copy.normalize();
+                std::vector<unsigned long long> result(copy.limbs.rbegin(), copy.limbs.rend());
+                trim_magnitude(result);
+                return result;
+            }
+        };
+
+        Side &side(bool is_negative)
+        {
+            return is_negative ? negative : positive;
+        }
+
+        Side positive, negative;
+    };
+
+    // Арифметика по фиксированному нечётному модулю, взаимно простому с module (не делится на 2 и 5).
+    // Вычеты хранятся в форме Монтгомери: x * R mod m, R = module^n, разряды - младший первым.
+    class MontgomeryContext
+    {
+    public:
+        using Residue = std::vector<unsigned long long>;
+
+        explicit MontgomeryContext(const BigInt &modulus)
+        {
+            _modulus = modulus.digits;
+            trim_magnitude(_modulus);
+            if (modulus.isNegative || !is_suitable_magnitude(_modulus))
+            {
+                throw std::exception();
+            }
+            _mod.assign(_modulus.rbegin(), _modulus.rend());
+            _n = _mod.size();
+            _inv = DEFAULT_MODULE - mod_inv(_mod[0]);
+
+            std::vector<unsigned long long> rem;
+            divmod_magnitude(shift_magnitude({1}, _n), _modulus, rem);
+            _one = from_magnitude_le(rem);
+            divmod_magnitude(shift_magnitude({1}, 2 * _n), _modulus, rem);
+            _r2 = from_magnitude_le(rem);
+        }
+
+        static bool is_suitable(const BigInt &modulus)
+        {
+            std::vector<unsigned long long> m = modulus.digits;
+            trim_magnitude(m);
+            return !modulus.isNegative && is_suitable_magnitude(m);
+        }
+
+        BigInt modulus() const
+        {
+            return from_magnitude(_modulus, false);
+        }
+
+        Residue to_montgomery(const BigInt &x) const
+        {
+            std::vector<unsigned long long> rem, value = x.digits;
+            trim_magnitude(value);
+            divmod_magnitude(value, _modulus, rem);
+            if (x.isNegative && !is_zero_magnitude(rem))
+            {
+                rem = sub_magnitude(_modulus, rem);
+            }
+            return multiply(from_magnitude_le(rem), _r2);
+        }
+
+        BigInt from_montgomery(const Residue &x) const
+        {
+            Residue plain_one(_n, 0);
+            plain_one[0] = 1;
+            Residue r = multiply(x, plain_one);
+            return from_magnitude(std::vector<unsigned long long>(r.rbegin(), r.rend()), false);
+        }
+
+        const Residue &one() const
+        {
+            return _one;
+        }
+
+        Residue zero() const
+        {
+            return Residue(_n, 0);
+        }
+
+        // Редукция Монтгомери, совмещённая с умножением (CIOS)
+        Residue multiply(const Residue &a, const Residue &b) const
+        {
+            std::vector<unsigned long long> t(_n + 2, 0);
+            for (size_t i = 0; i < _n; i++)
+            {
+                unsigned long long carry = 0;
+                for (size_t j = 0; j < _n; j++)
+                {
+                    unsigned long long cur = t[j] + a[j] * b[i] + carry;
+                    t[j] = cur % DEFAULT_MODULE;
+                    carry = cur / DEFAULT_MODULE;
+                }
+                unsigned long long cur = t[_n] + carry;
+                t[_n] = cur % DEFAULT_MODULE;
+                t[_n + 1] = cur / DEFAULT_MODULE;
+
+                const unsigned long long u = t[0] * _inv % DEFAULT_MODULE;
+                carry = (t[0] + u * _mod[0]) / DEFAULT_MODULE;
+                for (size_t j = 1; j < _n; j++)
+                {
+                    cur = t[j] + u * _mod[j] + carry;
+                    t[j - 1] = cur % DEFAULT_MODULE;
+                    carry = cur / DEFAULT_MODULE;
+                }
+                cur = t[_n] + carry;
+                t[_n - 1] = cur % DEFAULT_MODULE;
+                t[_n] = t[_n + 1] + cur / DEFAULT_MODULE;
+                t[_n + 1] = 0;
+            }
+            t.pop_back();
+            if (t[_n] != 0 || compare_le(t, _mod) >= 0)
+            {
+                subtract_le(t, _mod);
+            }
+            t.pop_back();
+            return t;
+        }
+
+        Residue square(const Residue &a) const
+        {
+            return multiply(a, a);
+        }
+
+        Residue add(const Residue &a, const Residue &b) const
+        {
+            Residue r(_n + 1, 0);
+            unsigned long long carry = 0;
+            for (size_t i = 0; i < _n; i++)
+            {
+                unsigned long long cur = a[i] + b[i] + carry;
+                r[i] = cur % DEFAULT_MODULE;
+                carry = cur / DEFAULT_MODULE;
+            }
+            r[_n] = carry;
+            if (carry != 0 || compare_le(r, _mod) >= 0)
+            {
+                subtract_le(r, _mod);
+            }
+            r.pop_back();
+            return r;
+        }
+
+        Residue sub(const Residue &a, const Residue &b) const
+        {
+            Residue r(_n, 0);
+            long long borrow = 0;
+            for (size_t i = 0; i < _n; i++)
+            {
+                long long cur = (long long)a[i] - (long long)b[i] - borrow;
+                borrow = cur < 0;
+                r[i] = cur < 0 ? cur + DEFAULT_MODULE : cur;
+            }
+            if (borrow)
+            {
+                unsigned long long carry = 0;
+                for (size_t i = 0; i < _n; i++)
+                {
+                    unsigned long long cur = r[i] + _mod[i] + carry;
+                    r[i] = cur % DEFAULT_MODULE;
+                    carry = cur / DEFAULT_MODULE;
+                }
+            }
+            return r;
+        }
+
+        // x / 2 mod m
+        Residue half(const Residue &a) const
+        {
+            Residue r = a;
+            r.push_back(0);
+            if (r[0] % 2 == 1)
+            {
+                unsigned long long carry = 0;
+                for (size_t i = 0; i < _n; i++)
+                {
+                    unsigned long long cur = r[i] + _mod[i] + carry;
+                    r[i] = cur % DEFAULT_MODULE;
+                    carry = cur / DEFAULT_MODULE;
+                }
+                r[_n] = carry;
+            }
+            unsigned long long rest = 0;
+            for (size_t i = _n + 1; i-- > 0;)
+            {
+                unsigned long long cur = rest * DEFAULT_MODULE + r[i];
+                r[i] = cur / 2;
+                rest = cur % 2;
+            }
+            r.pop_back();
+            return r;
+        }
+
+        // Возведение в степень скользящим окном, показатель - двоичные слова, младшее первым
+        Residue pow(const Residue &base, const std::vector<uint32_t> &exp) const
+        {
+            size_t bits = exp.size() * 32;
+            while (bits > 0 && !((exp[(bits - 1) / 32] >> ((bits - 1) % 32)) & 1))
+            {
+                --bits;
+            }
+            if (bits == 0)
+            {
+                return _one;
+            }
+
+            const size_t window = bits > 256 ? 5 : (bits > 32 ? 4 : 1);
+            std::vector<Residue> odd_powers(size_t(1) << (window - 1));
+            odd_powers[0] = base;
+            const Residue base_sq = square(base);
+            for (size_t i = 1; i < odd_powers.size(); i++)
+            {
+                odd_powers[i] = multiply(odd_powers[i - 1], base_sq);
+            }
+
+            auto bit = [&exp](size_t i)
+            { return (exp[i / 32] >> (i % 32)) & 1; };
+
+            Residue result = _one;
+            bool started = false;
+            size_t i = bits;
+            while (i > 0)
+            {
+                progress_point((double)(bits - i) / (double)bits);
+                if (!bit(i - 1))
+                {
+                    if (started)
+                    {
+                        result = square(result);
+                    }
+                    --i;
+                    continue;
+                }
+                size_t low = i > window ? i - window : 0;
+                while (!bit(low))
+                {
+                    ++low;
+                }
+                unsigned value = 0;
+                for (size_t j = i; j-- > low;)
+                {
+                    value = (value << 1) | bit(j);
+                    if (started)
+                    {
+                        result = square(result);
+                    }
+                }
+                result = started ? multiply(result, odd_powers[value / 2]) : odd_powers[value / 2];
+                started = true;
+                i = low;
+            }
+            return result;
+        }
+
+        BigInt pow(const BigInt &base, const BigInt &exp) const
+        {
+            BIGINT_TELEMETRY_SCOPE(TelemetryOp::mod_exp_montgomery, _n);
+            if (exp.isNegative)
+            {
+                throw std::exception();
+            }
+            return from_montgomery(pow(to_montgomery(base), to_binary_words(exp.digits)));
+        }
+
+    private:
+        static bool is_suitable_magnitude(const std::vector<unsigned long long> &m)
+        {
+            return m.back() % 2 == 1 && m.back() % 5 != 0 && !(m.size() == 1 && m[0] == 1);
+        }
+
+        Residue from_magnitude_le(const std::vector<unsigned long long> &mag) const
+        {
+            Residue r(mag.rbegin(), mag.rend());
+            r.resize(_n, 0);
+            return r;
+        }
+
+        static int compare_le(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+        {
+            for (size_t i = std::max(a.size(), b.size()); i-- > 0;)
+            {
+                unsigned long long x = i < a.size() ? a[i] : 0, y = i < b.size() ? b[i] : 0;
+                if (x != y)
+                {
+                    return x < y ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        static void subtract_le(std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+        {
+            long long borrow = 0;
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                long long cur = (long long)a[i] - (long long)(i < b.size() ? b[i] : 0) - borrow;
+                borrow = cur < 0;
+                a[i] = cur < 0 ? cur + DEFAULT_MODULE : cur;
+            }
+        }
+
+        std::vector<unsigned long long> _modulus;
+        Residue _mod, _one, _r2;
+        size_t _n;
+        unsigned long long _inv;
+    };
+
+    // Арифметика по фиксированному модулю любого вида. Вычеты - обычные модули чисел из [0, m),
+    // произведения приводятся по Барретту с обратным к модулю, посчитанным один раз
+    class BarrettContext
+    {
+    public:
+        using Residue = std::vector<unsigned long long>;
+
+        explicit BarrettContext(const BigInt &modulus)
+        {
+            _modulus = modulus.magnitude();
+            if (modulus.is_negative() || is_zero_magnitude(_modulus))
+            {
+                throw std::exception();
+            }
+            _inverse = barrett_inverse(_modulus);
+            _one = to_residue(BigInt(1));
+        }
+
+        BigInt modulus() const
+        {
+            return from_magnitude(_modulus, false);
+        }
+
+        Residue to_residue(const BigInt &x) const
+        {
+            std::vector<unsigned long long> rem;
+            divmod_magnitude(x.magnitude(), _modulus, rem);
+            if (x.is_negative() && !is_zero_magnitude(rem))
+            {
+                rem = sub_magnitude(_modulus, rem);
+            }
+            return rem;
+        }
+
+        BigInt from_residue(const Residue &x) const
+        {
+            return from_magnitude(x, false);
+        }
+
+        const Residue &one() const
+        {
+            return _one;
+        }
+
+        Residue zero() const
+        {
+            return {0};
+        }
+
+        Residue multiply(const Residue &a, const Residue &b) const
+        {
+            return reduce(fast_mul_magnitude(a, b));
+        }
+
+        Residue square(const Residue &a) const
+        {
+            return reduce(sqr_magnitude(a));
+        }
+
+        Residue add(const Residue &a, const Residue &b) const
+        {
+            Residue r = add_magnitude(a, b);
+            return compare_magnitude(r, _modulus) >= 0 ? sub_magnitude(r, _modulus) : r;
+        }
+
+        Residue sub(const Residue &a, const Residue &b) const
+        {
+            return compare_magnitude(a, b) >= 0 ? sub_magnitude(a, b) : sub_magnitude(add_magnitude(a, _modulus), b);
+        }
+
+    private:
+        // x < m^2
+        Residue reduce(const std::vector<unsigned long long> &x) const
+        {
+            std::vector<unsigned long long> rem;
+            barrett_divmod(x, _modulus, _inverse, rem);
+            return rem;
+        }
+
+        std::vector<unsigned long long> _modulus, _inverse;
+        Residue _one;
+    };
+
+    // Вероятностная проверка простоты: пробное деление, тест Миллера-Рабина по основанию 2
+    // и сильный тест Люка (BPSW), затем ещё rounds раундов Миллера-Рабина со случайными основаниями
+    bool is_probable_prime(unsigned rounds = 0) const
+    {
+        std::vector<unsigned long long> n = digits;
+        trim_magnitude(n);
+        if (isNegative || (n.size() == 1 && n[0] < 2))
+        {
+            return false;
+        }
+
+        const std::vector<unsigned long long> &primes = small_primes();
+        std::vector<unsigned long long> residues = small_prime_residues(n);
+        for (size_t i = 0; i < primes.size(); i++)
+        {
+            if (residues[i] == 0)
+            {
+                return n.size() == 1 && n[0] == primes[i];
+            }
+        }
+        if (n.size() == 1 && n[0] < primes.back() * primes.back())
+        {
+            return true;
+        }
+        return probable_prime_after_sieve(n, rounds);
+    }
+
+    // Наименьшее вероятно простое число, большее *this
+    BigInt next_prime(unsigned rounds = 0) const
+    {
+        std::vector<unsigned long long> n = digits;
+        trim_magnitude(n);
+        if (isNegative || (n.size() == 1 && n[0] < 2))
+        {
+            return BigInt(2);
+        }
+
+        const std::vector<unsigned long long> &primes = small_primes();
+        if (n.size() == 1 && n[0] < primes.back())
+        {
+            return BigInt((long long)*std::upper_bound(primes.begin(), primes.end(), n[0]));
+        }
+
+        // Решето по окну [start, start + SIEVE_WINDOW): вычеты start по малым простым
+        // считаются один раз и сдвигаются вместе с окном без длинной арифметики
+        std::vector<unsigned long long> start = linear_combination(1, n, 1, {1});
+        std::vector<unsigned long long> residues = small_prime_residues(start);
+        std::vector<bool> composite(SIEVE_WINDOW);
+        while (true)
+        {
+            std::fill(composite.begin(), composite.end(), false);
+            for (size_t i = 0; i < primes.size(); i++)
+            {
+                unsigned long long p = primes[i];
+                for (unsigned long long off = (p - residues[i]) % p; off < SIEVE_WINDOW; off += p)
+                {
+                    composite[off] = true;
+                }
+            }
+            for (unsigned long long off = 0; off < SIEVE_WINDOW; off++)
+            {
+                if (composite[off])
+                {
+                    continue;
+                }
+                std::vector<unsigned long long> candidate = linear_combination(1, start, 1, small_magnitude(off));
+                if (probable_prime_after_sieve(candidate, rounds))
+                {
+                    return from_magnitude(std::move(candidate), false);
+                }
+            }
+            start = linear_combination(1, start, 1, small_magnitude(SIEVE_WINDOW));
+            for (size_t i = 0; i < primes.size(); i++)
+            {
+                residues[i] = (residues[i] + SIEVE_WINDOW) % primes[i];
+            }
+        }
+    }
+
+    // Модуль числа в виде байтов: слова по word_size байт, порядок слов word_order,
+    // порядок байтов внутри слова byte_order. Ноль даёт пустой массив, знак не сохраняется
+    std::vector<uint8_t> export_bytes(size_t word_size = 1, std::endian word_order = std::endian::big, std::endian byte_order = std::endian::native) const
+    {
+        if (word_size == 0)
+        {
+            throw std::exception();
+        }
+        std::vector<uint32_t> words = to_binary_words(magnitude());
+        std::vector<uint8_t> bytes; // младший байт первым
+        bytes.reserve(words.size() * 4);
+        for (uint32_t word : words)
+        {
+            for (int i = 0; i < 4; i++)
+            {
+                bytes.push_back((uint8_t)(word >> (8 * i)));
+            }
+        }
+        while (!bytes.empty() && bytes.back() == 0)
+        {
+            bytes.pop_back();
+        }
+
+        const size_t count = (bytes.size() + word_size - 1) / word_size;
+        std::vector<uint8_t> result(count * word_size, 0);
+        for (size_t i = 0; i < bytes.size(); i++)
+        {
+            result[byte_position(i, count, word_size, word_order, byte_order)] = bytes[i];
+        }
+        return result;
+    }
+
+    static BigInt import_bytes(const uint8_t *data, size_t size, size_t word_size = 1, std::endian word_order = std::endian::big, std::endian byte_order = std::endian::native, bool negative = false)
+    {
+        if (word_size == 0 || size % word_size != 0)
+        {
+            throw std::exception();
+        }
+        const size_t count = size / word_size;
+        std::vector<uint32_t> words((size + 3) / 4, 0);
+        for (size_t i = 0; i < size; i++)
+        {
+            words[i / 4] |= (uint32_t)data[byte_position(i, count, word_size, word_order, byte_order)] << (8 * (i % 4));
+        }
+        return from_magnitude(from_binary_words(words), negative);
+    }
+
+    static BigInt import_bytes(const std::vector<uint8_t> &bytes, size_t word_size = 1, std::endian word_order = std::endian::big, std::endian byte_order = std::endian::native, bool negative = false)
+    {
+        return import_bytes(bytes.data(), bytes.size(), word_size, word_order, byte_order, negative);
+    }
+
+    // Запись в системе счисления base (2..36), цифры 0-9a-z. Степени двойки переводятся
+    // нарезкой двоичного представления, остальные - делением пополам на степени основания
+    std::string to_string(unsigned base) const
+    {
+        BIGINT_TELEMETRY_SCOPE(base == 10 ? TelemetryOp::print_decimal : TelemetryOp::print_radix, digits.size());
+        if (base < 2 || base > 36)
+        {
+            throw std::exception();
+        }
+        if (base == 10)
+        {
+            std::string result = to_string(*this);
+            return is_negative() ? "-" + result : result;
+        }
+
+        std::string result;
+        if (std::has_single_bit(base))
+        {
+            const unsigned bits = std::countr_zero(base);
+            std::vector<uint32_t> words = to_binary_words(magnitude());
+            const size_t total = words.size() * 32;
+            for (size_t pos = 0; pos < total; pos += bits)
+            {
+                unsigned long long cur = words[pos / 32] >> (pos % 32);
+                if (pos % 32 + bits > 32 && pos / 32 + 1 < words.size())
+                {
+                    cur |= (unsigned long long)words[pos / 32 + 1] << (32 - pos % 32);
+                }
+                result += DIGIT_CHARS[cur & (base - 1)];
+            }
+        }
+        else
+        {
+            unsigned digits_per_chunk = 0;
+            const unsigned long long radix = chunk_radix(base, digits_per_chunk);
+            for (unsigned long long chunk : magnitude_to_chunks(magnitude(), radix))
+            {
+                for (unsigned i = 0; i < digits_per_chunk; i++, chunk /= base)
+                {
+                    result += DIGIT_CHARS[chunk % base];
+                }
+            }
+        }
+        while (result.size() > 1 && result.back() == '0')
+        {
+            result.pop_back();
+        }
+        if (result.empty())
+        {
+            result = "0";
+        }
+        if (is_negative())
+        {
+            result += '-';
+        }
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    // Разбор записи в системе счисления base; конструктор (string, module) уже занят под основание хранения
+    static BigInt from_string(const std::string &str, unsigned base)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::parse_radix, str.size() / 9 + 1);
+        if (base < 2 || base > 36)
+        {
+            throw std::exception();
+        }
+        const bool negative = !str.empty() && str[0] == '-';
+        const size_t begin = negative ? 1 : 0;
+        if (begin == str.size())
+        {
+            throw std::exception();
+        }
+        std::vector<unsigned> values; // младшая цифра первой
+        values.reserve(str.size() - begin);
+        for (size_t i = str.size(); i-- > begin;)
+        {
+            values.push_back(digit_value(str[i], base));
+        }
+
+        if (std::has_single_bit(base))
+        {
+            const unsigned bits = std::countr_zero(base);
+            std::vector<uint32_t> words((values.size() * bits + 31) / 32, 0);
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                const size_t pos = i * bits;
+                words[pos / 32] |= (uint32_t)((unsigned long long)values[i] << (pos % 32));
+                if (pos % 32 + bits > 32)
+                {
+                    words[pos / 32 + 1] |= values[i] >> (32 - pos % 32);
+                }
+            }
+            return from_magnitude(from_binary_words(words), negative);
+        }
+
+        unsigned digits_per_chunk = 0;
+        const unsigned long long radix = chunk_radix(base, digits_per_chunk);
+        std::vector<unsigned long long> chunks((values.size() + digits_per_chunk - 1) / digits_per_chunk, 0);
+        for (size_t i = values.size(); i-- > 0;)
+        {
+            chunks[i / digits_per_chunk] = chunks[i / digits_per_chunk] * base + values[i];
+        }
+        return from_magnitude(chunks_to_magnitude(chunks, radix), negative);
+    }
+
+    /* static unsigned long long mod_inv(unsigned long long a, unsigned int MOD)
+    {
+        unsigned long long res = 1;
+        unsigned long long p = MOD - 2;
+        while (p)
+        {
+            if (p & 1)
+                res = (res * a) % MOD;
+            a = (a * a) % MOD;
+            p >>= 1;
+        }
+        return res;
+    } */
+
+private:
+    static constexpr unsigned long long DEFAULT_MODULE = 1000000000;
+    // Начиная с этой длины (в разрядах) НОД считается рекурсивно по старшим половинам
+    static constexpr size_t HGCD_THRESHOLD = 40;
+
+    __extension__ using int128 = __int128;
+    __extension__ using uint128 = unsigned __int128;
+
+    // Матрица кофакторов: (a_cur, b_cur) = m * (a_0, b_0)
+    struct GcdMatrix
+    {
+        std::vector<BigInt> m = {BigInt(1), BigInt(0), BigInt(0), BigInt(1)};
+
+        BigInt &at(int row, int col)
+        {
+            return m[2 * row + col];
+        }
+
+        // this = step * this; произведения идут через быстрое умножение, иначе half-GCD квадратичен
+        void left_multiply(const BigInt &s00, const BigInt &s01, const BigInt &s10, const BigInt &s11)
+        {
+            for (int col = 0; col < 2; col++)
+            {
+                BigInt top = s00.karatsuba_multiply(at(0, col)) + s01.karatsuba_multiply(at(1, col));
+                BigInt bottom = s10.karatsuba_multiply(at(0, col)) + s11.karatsuba_multiply(at(1, col));
+                at(0, col) = std::move(top);
+                at(1, col) = std::move(bottom);
+            }
+        }
+    };
+
+    static BigInt from_magnitude(std::vector<unsigned long long> mag, bool negative)
+    {
+        trim_magnitude(mag);
+        BigInt result;
+        result.digits = std::move(mag);
+        result.isNegative = negative && !(result.digits.size() == 1 && result.digits[0] == 0);
+        return result;
+    }
+
+    // Убирает ведущие нули, пустой вектор превращает в {0}
+    static void trim_magnitude(std::vector<unsigned long long> &mag)
+    {
+        size_t zeroes = 0;
+        while (zeroes + 1 < mag.size() && mag[zeroes] == 0)
+        {
+            ++zeroes;
+        }
+        mag.erase(mag.begin(), mag.begin() + zeroes);
+        if (mag.empty())
+        {
+            mag.push_back(0);
+        }
+    }
+
+    // Сравнение модулей без учёта знака. Разряды сверяются блоками по 4 без ветвлений внутри блока,
+    // такой цикл векторизуется, и только в блоке с отличием ищется первый несовпавший разряд
+    static int compare_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+    {
+        if (a.size() != b.size())
+        {
+            return a.size() < b.size() ? -1 : 1;
+        }
+        const size_t n = a.size();
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            if (((a[i] ^ b[i]) | (a[i + 1] ^ b[i + 1]) | (a[i + 2] ^ b[i + 2]) | (a[i + 3] ^ b[i + 3])) != 0)
+            {
+                break;
+            }
+        }
+        for (; i < n; i++)
+        {
+            if (a[i] != b[i])
+            {
+                return a[i] < b[i] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    // Модуль числа; у BigInt() разрядов нет вовсе, он считается нулём
+    const std::vector<unsigned long long> &magnitude() const
+    {
+        static const std::vector<unsigned long long> zero_magnitude{0};
+        return digits.empty() ? zero_magnitude : static_cast<const std::vector<unsigned long long> &>(digits);
+    }
+
+    // Знак с учётом того, что "-0" - это ноль
+    bool is_negative() const
+    {
+        return isNegative && !(digits.empty() || (digits.size() == 1 && digits[0] == 0));
+    }
+
+    // a - b, требуется a >= b
+    static std::vector<unsigned long long> sub_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+    {
+        std::vector<unsigned long long> result(a.size());
+        long long borrow = 0;
+        for (size_t i = a.size(), j = b.size(); i-- > 0;)
+        {
+            long long cur = (long long)a[i] - borrow - (j > 0 ? (long long)b[--j] : 0);
+            borrow = cur < 0;
+            result[i] = cur < 0 ? cur + DEFAULT_MODULE : cur;
+        }
+        trim_magnitude(result);
+        return result;
+    }
+
+    static std::vector<unsigned long long> mul_small_magnitude(const std::vector<unsigned long long> &a, unsigned long long m)
+    {
+        std::vector<unsigned long long> result(a.size() + 1);
+        unsigned long long carry = 0;
+        for (size_t i = a.size(); i-- > 0;)
+        {
+            unsigned long long cur = a[i] * m + carry;
+            result[i + 1] = cur % DEFAULT_MODULE;
+            carry = cur / DEFAULT_MODULE;
+        }
+        result[0] = carry;
+        return result;
+    }
+
+    // Деление столбиком (Кнут, алгоритм D), возвращает частное, остаток кладёт в rem
+    static std::vector<unsigned long long> divmod_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b, std::vector<unsigned long long> &rem)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::div_knuth, a.size() + b.size());
+        std::vector<unsigned long long> u = a, v = b;
+        trim_magnitude(u);
+        trim_magnitude(v);
+        if (v.size() == 1 && v[0] == 0)
+        {
+            throw std::exception();
+        }
+        if (compare_magnitude(u, v) < 0)
+        {
+            rem = u;
+            return {0};
+        }
+        if (v.size() == 1)
+        {
+            std::vector<unsigned long long> q(u.size());
+            unsigned long long r = 0;
+            for (size_t i = 0; i < u.size(); i++)
+            {
+                unsigned long long cur = r * DEFAULT_MODULE + u[i];
+                q[i] = cur / v[0];
+                r = cur % v[0];
+            }
+            trim_magnitude(q);
+            rem = {r};
+            return q;
+        }
+
+        const unsigned long long d = DEFAULT_MODULE / (v[0] + 1);
+        u = mul_small_magnitude(u, d);
+        v = mul_small_magnitude(v, d);
+        v.erase(v.begin());
+
+        const size_t n = v.size(), m = u.size() - n;
+        std::vector<unsigned long long> q(m);
+        for (size_t j = 0; j < m; j++)
+        {
+            if (j % 64 == 0)
+            {
+                progress_point((double)j / (double)m);
+            }
+            unsigned long long num = u[j] * DEFAULT_MODULE + u[j + 1];
+            unsigned long long qhat = num / v[0], rhat = num % v[0];
+            while (qhat >= DEFAULT_MODULE || qhat * v[1] > rhat * DEFAULT_MODULE + u[j + 2])
+            {
+                --qhat;
+                rhat += v[0];
+                if (rhat >= DEFAULT_MODULE)
+                {
+                    break;
+                }
+            }
+
+            long long borrow = 0;
+            unsigned long long carry = 0;
+            for (size_t i = n; i-- > 0;)
+            {
+                unsigned long long p = qhat * v[i] + carry;
+                carry = p / DEFAULT_MODULE;
+                long long cur = (long long)u[j + 1 + i] - (long long)(p % DEFAULT_MODULE) - borrow;
+                borrow = cur < 0;
+                u[j + 1 + i] = cur < 0 ? cur + DEFAULT_MODULE : cur;
+            }
+            long long top = (long long)u[j] - (long long)carry - borrow;
+            if (top < 0)
+            {
+                --qhat;
+                unsigned long long add_carry = 0;
+                for (size_t i = n; i-- > 0;)
+                {
+                    unsigned long long cur = u[j + 1 + i] + v[i] + add_carry;
+                    add_carry = cur / DEFAULT_MODULE;
+                    u[j + 1 + i] = cur % DEFAULT_MODULE;
+                }
+                top += add_carry;
+            }
+            u[j] = top;
+            q[j] = qhat;
+        }
+
+        rem.assign(u.begin() + m, u.end());
+        unsigned long long r = 0;
+        for (size_t i = 0; i < rem.size(); i++)
+        {
+            unsigned long long cur = r * DEFAULT_MODULE + rem[i];
+            rem[i] = cur / d;
+            r = cur % d;
+        }
+        trim_magnitude(rem);
+        trim_magnitude(q);
+        return q;
+    }
+
+    // Умножение столбиком
+    static std::vector<unsigned long long> mul_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_schoolbook, a.size() + b.size());
+        std::vector<unsigned long long> result(a.size() + b.size(), 0);
+        for (size_t i = a.size(); i-- > 0;)
+        {
+            if (a[i] == 0)
+            {
+                continue;
+            }
+            unsigned long long carry = 0;
+            for (size_t j = b.size(); j-- > 0;)
+            {
+                unsigned long long cur = result[i + j + 1] + a[i] * b[j] + carry;
+                result[i + j + 1] = cur % DEFAULT_MODULE;
+                carry = cur / DEFAULT_MODULE;
+            }
+            result[i] = carry;
+        }
+        trim_magnitude(result);
+        return result;
+    }
+
+    // Квадрат столбиком: попарные произведения a[i] * a[j], i != j, считаются один раз и удваиваются
+    static std::vector<unsigned long long> sqr_schoolbook_magnitude(const std::vector<unsigned long long> &a)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_schoolbook, 2 * a.size());
+        const size_t n = a.size();
+        std::vector<unsigned long long> result(2 * n, 0);
+        for (size_t i = n; i-- > 1;)
+        {
+            if (a[i] == 0)
+            {
+                continue;
+            }
+            unsigned long long carry = 0;
+            for (size_t j = i; j-- > 0;)
+            {
+                unsigned long long cur = result[i + j + 1] + a[i] * a[j] + carry;
+                result[i + j + 1] = cur % DEFAULT_MODULE;
+                carry = cur / DEFAULT_MODULE;
+            }
+            result[i] = carry;
+        }
+        unsigned long long carry = 0;
+        for (size_t i = n; i-- > 0;)
+        {
+            const unsigned long long sq = a[i] * a[i];
+            unsigned long long cur = 2 * result[2 * i + 1] + sq % DEFAULT_MODULE + carry;
+            result[2 * i + 1] = cur % DEFAULT_MODULE;
+            carry = cur / DEFAULT_MODULE;
+            cur = 2 * result[2 * i] + sq / DEFAULT_MODULE + carry;
+            result[2 * i] = cur % DEFAULT_MODULE;
+            carry = cur / DEFAULT_MODULE;
+        }
+        trim_magnitude(result);
+        return result;
+    }
+
+    static std::vector<unsigned long long> pow_magnitude(const std::vector<unsigned long long> &a, unsigned long long exp)
+    {
+        std::vector<unsigned long long> result{1}, base = a;
+        while (exp != 0)
+        {
+            if (exp & 1)
+            {
+                result = fast_mul_magnitude(result, base);
+            }
+            exp >>= 1;
+            if (exp != 0)
+            {
+                base = sqr_magnitude(base);
+            }
+        }
+        return result;
+    }
+
+    static std::vector<unsigned long long> small_magnitude(unsigned long long value)
+    {
+        std::vector<unsigned long long> result;
+        do
+        {
+            result.push_back(value % DEFAULT_MODULE);
+            value /= DEFAULT_MODULE;
+        } while (value != 0);
+        std::reverse(result.begin(), result.end());
+        return result;
+    }
+
+    // Сдвиг на count разрядов: умножение на module^count
+    static std::vector<unsigned long long> shift_magnitude(std::vector<unsigned long long> a, size_t count)
+    {
+        if (!is_zero_magnitude(a))
+        {
+            a.resize(a.size() + count, 0);
+        }
+        return a;
+    }
+
+    // Корень степени k: по старшим разрядам рекурсивно получаем корень вдвое меньшей точности,
+    // затем доводим методом Ньютона сверху: x = ((k - 1) * x + n / x^(k - 1)) / k
+    static std::vector<unsigned long long> iroot_magnitude(const std::vector<unsigned long long> &n, unsigned long long k)
+    {
+        if (is_zero_magnitude(n))
+        {
+            return {0};
+        }
+        const size_t len = n.size();
+        // n < 2^(30 * len)
+        if (k >= 30 * len)
+        {
+            return {1};
+        }
+        const size_t h = len / (2 * k);
+
+        std::vector<unsigned long long> x;
+        if (h >= 1 && len > 2)
+        {
+            std::vector<unsigned long long> top(n.begin(), n.end() - k * h);
+            std::vector<unsigned long long> root = iroot_magnitude(top, k);
+            root = linear_combination(1, root, 1, {1});
+            x = shift_magnitude(root, h);
+        }
+        else
+        {
+            x = iroot_upper_estimate(n, k);
+        }
+
+        const std::vector<unsigned long long> k_mag = small_magnitude(k), k1_mag = small_magnitude(k - 1);
+        while (true)
+        {
+            std::vector<unsigned long long> rem;
+            std::vector<unsigned long long> y = quotient_magnitude(n, pow_magnitude(x, k - 1));
+            y = linear_combination(1, y, 1, mul_magnitude(x, k1_mag));
+            y = divmod_magnitude(y, k_mag, rem);
+            if (compare_magnitude(y, x) >= 0)
+            {
+                return x;
+            }
+            // Итерации сверху не опускаются ниже корня, поэтому y^k <= n означает, что y - ответ;
+            // возведение в степень дешевле ещё одного деления, которое лишь подтвердило бы сходимость
+            if (compare_magnitude(pow_magnitude(y, k), n) <= 0)
+            {
+                return y;
+            }
+            x.swap(y);
+        }
+    }
+
+    // floor(a / b): при длинных делителе и частном - через обратное Ньютона, иначе столбиком
+    static std::vector<unsigned long long> quotient_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+    {
+        if (b.size() > BARRETT_THRESHOLD && a.size() > b.size() + BARRETT_THRESHOLD)
+        {
+            return newton_divide_mas(a, b).first;
+        }
+        std::vector<unsigned long long> rem;
+        return divmod_magnitude(a, b, rem);
+    }
+
+    // Оценка корня сверху по старшим разрядам, корень при этом меньше module^2
+    static std::vector<unsigned long long> iroot_upper_estimate(const std::vector<unsigned long long> &n, unsigned long long k)
+    {
+        long double log_n = std::log10((long double)leading_limbs(n, std::max<size_t>(n.size(), 2)) + 1) + (long double)(n.size() > 2 ? n.size() - 2 : 0) * 9;
+        long double estimate = std::pow((long double)10, log_n / (long double)k);
+        unsigned long long x = (estimate >= 1e18L) ? 999999999999999999ULL : (unsigned long long)(estimate * (1 + 1e-9L)) + 2;
+
+        std::vector<unsigned long long> result = small_magnitude(x);
+        while (compare_magnitude(pow_magnitude(result, k), n) <= 0)
+        {
+            result = mul_magnitude(result, {2});
+        }
+        return result;
+    }
+
+    // Быстрый отсев неквадратов по вычетам: mod 512 по младшему разряду, mod 63, 65, 11 - за один проход
+    static bool square_residue_filter(const std::vector<unsigned long long> &n)
+    {
+        static const std::vector<bool> squares_512 = quadratic_residues(512);
+        static const std::vector<bool> squares_63 = quadratic_residues(63);
+        static const std::vector<bool> squares_65 = quadratic_residues(65);
+        static const std::vector<bool> squares_11 = quadratic_residues(11);
+
+        if (!squares_512[n.back() % 512])
+        {
+            return false;
+        }
+        unsigned long long r = 0;
+        for (unsigned long long limb : n)
+        {
+            r = (r * DEFAULT_MODULE + limb) % 45045;
+        }
+        return squares_63[r % 63] && squares_65[r % 65] && squares_11[r % 11];
+    }
+
+    static std::vector<bool> quadratic_residues(unsigned long long m)
+    {
+        std::vector<bool> result(m, false);
+        for (unsigned long long i = 0; i < m; i++)
+        {
+            result[i * i % m] = true;
+        }
+        return result;
+    }
+
+    static constexpr unsigned long long SMALL_PRIMES_LIMIT = 2000;
+    static constexpr unsigned long long SIEVE_WINDOW = 4096;
+
+    static const std::vector<unsigned long long> &small_primes()
+    {
+        static const std::vector<unsigned long long> primes = []()
+        {
+            std::vector<unsigned long long> result;
+            std::vector<bool> sieve(SMALL_PRIMES_LIMIT, true);
+            for (unsigned long long i = 2; i < SMALL_PRIMES_LIMIT; i++)
+            {
+                if (!sieve[i])
+                {
+                    continue;
+                }
+                result.push_back(i);
+                for (unsigned long long j = i * i; j < SMALL_PRIMES_LIMIT; j += i)
+                {
+                    sieve[j] = false;
+                }
+            }
+            return result;
+        }();
+        return primes;
+    }
+
+    // Остатки n по всем малым простым: простые группируются так, чтобы произведение
+    // помещалось в слово, и на каждую группу делается один проход по разрядам
+    static std::vector<unsigned long long> small_prime_residues(const std::vector<unsigned long long> &n)
+    {
+        const std::vector<unsigned long long> &primes = small_primes();
+        std::vector<unsigned long long> residues(primes.size());
+        size_t i = 0;
+        while (i < primes.size())
+        {
+            unsigned long long group = 1;
+            size_t j = i;
+            while (j < primes.size() && group * primes[j] < (1ULL << 34))
+            {
+                group *= primes[j++];
+            }
+            unsigned long long r = 0;
+            for (unsigned long long limb : n)
+            {
+                r = (r * DEFAULT_MODULE + limb) % group;
+            }
+            for (; i < j; i++)
+            {
+                residues[i] = r % primes[i];
+            }
+        }
+        return residues;
+    }
+
+    // Перевод в двоичную систему: слова по 32 бита, младшее первым
+    static std::vector<uint32_t> to_binary_words(const std::vector<unsigned long long> &mag)
+    {
+        if (is_zero_magnitude(mag))
+        {
+            return {};
+        }
+        std::vector<unsigned long long> chunks = magnitude_to_chunks(mag, 1ULL << 32);
+        return std::vector<uint32_t>(chunks.begin(), chunks.end());
+    }
+
+    // Обратный перевод из 32-битных слов (младшее первым) в разряды по основанию module
+    static std::vector<unsigned long long> from_binary_words(const std::vector<uint32_t> &words)
+    {
+        return chunks_to_magnitude(std::vector<unsigned long long>(words.begin(), words.end()), 1ULL << 32);
+    }
+
+    // Где в массиве из count слов лежит i-й по старшинству (с младшего) байт числа
+    static size_t byte_position(size_t i, size_t count, size_t word_size, std::endian word_order, std::endian byte_order)
+    {
+        const size_t word = i / word_size, byte = i % word_size;
+        const size_t word_index = word_order == std::endian::little ? word : count - 1 - word;
+        const size_t byte_index = byte_order == std::endian::little ? byte : word_size - 1 - byte;
+        return word_index * word_size + byte_index;
+    }
+
+    static std::vector<uint32_t> shift_right_words(const std::vector<uint32_t> &words, size_t shift)
+    {
+        std::vector<uint32_t> result;
+        for (size_t i = shift / 32; i < words.size(); i++)
+        {
+            unsigned long long cur = words[i] >> (shift % 32);
+            if (shift % 32 != 0 && i + 1 < words.size())
+            {
+                cur |= (unsigned long long)words[i + 1] << (32 - shift % 32);
+            }
+            result.push_back((uint32_t)cur);
+        }
+        return result;
+    }
+
+    static size_t trailing_zero_bits(const std::vector<uint32_t> &words)
+    {
+        size_t count = 0;
+        for (uint32_t word : words)
+        {
+            if (word != 0)
+            {
+                return count + std::countr_zero(word);
+            }
+            count += 32;
+        }
+        return count;
+    }
+
+    // Символ Якоби (a / n) для малого a и нечётного n
+    static int jacobi_small(long long a, const std::vector<unsigned long long> &n)
+    {
+        int result = 1;
+        const unsigned long long n_mod_8 = n.back() % 8;
+        if (a < 0)
+        {
+            a = -a;
+            if (n_mod_8 % 4 == 3)
+            {
+                result = -result;
+            }
+        }
+        while (a % 2 == 0 && a != 0)
+        {
+            a /= 2;
+            if (n_mod_8 == 3 || n_mod_8 == 5)
+            {
+                result = -result;
+            }
+        }
+        if (a == 1)
+        {
+            return result;
+        }
+        // Квадратичный закон взаимности, дальше всё в машинных словах
+        if (a % 4 == 3 && n_mod_8 % 4 == 3)
+        {
+            result = -result;
+        }
+        unsigned long long x = 0, y = a;
+        for (unsigned long long limb : n)
+        {
+            x = (x * DEFAULT_MODULE + limb) % y;
+        }
+        while (x != 0)
+        {
+            while (x % 2 == 0)
+            {
+                x /= 2;
+                if (y % 8 == 3 || y % 8 == 5)
+                {
+                    result = -result;
+                }
+            }
+            std::swap(x, y);
+            if (x % 4 == 3 && y % 4 == 3)
+            {
+                result = -result;
+            }
+            x %= y;
+        }
+        return y == 1 ? result : 0;
+    }
+
+    static bool miller_rabin_round(const MontgomeryContext &ctx, const MontgomeryContext::Residue &base, const std::vector<uint32_t> &d, size_t s)
+    {
+        const MontgomeryContext::Residue minus_one = ctx.sub(ctx.zero(), ctx.one());
+        MontgomeryContext::Residue x = ctx.pow(base, d);
+        if (x == ctx.one() || x == minus_one)
+        {
+            return true;
+        }
+        for (size_t r = 1; r < s; r++)
+        {
+            x = ctx.square(x);
+            if (x == minus_one)
+            {
+                return true;
+            }
+            if (x == ctx.one())
+            {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    // Сильный тест Люка с параметрами Селфриджа: P = 1, Q = (1 - D) / 4
+    static bool strong_lucas_test(const MontgomeryContext &ctx, const std::vector<unsigned long long> &n)
+    {
+        long long D = 5;
+        for (int attempt = 0;; attempt++)
+        {
+            int j = jacobi_small(D, n);
+            if (j == -1)
+            {
+                break;
+            }
+            if (j == 0 && !(n.size() == 1 && (long long)n[0] == std::llabs(D)))
+            {
+                return false;
+            }
+            if (attempt == 10 && from_magnitude(n, false).is_perfect_square())
+            {
+                return false;
+            }
+            D = D > 0 ? -(D + 2) : -D + 2;
+        }
+
+        std::vector<uint32_t> n_plus_1 = to_binary_words(linear_combination(1, n, 1, {1}));
+        const size_t s = trailing_zero_bits(n_plus_1);
+        const std::vector<uint32_t> d = shift_right_words(n_plus_1, s);
+
+        using Residue = MontgomeryContext::Residue;
+        const Residue D_res = ctx.to_montgomery(BigInt(D)), Q_res = ctx.to_montgomery(BigInt((1 - D) / 4));
+        Residue U = ctx.one(), V = ctx.one(), Qk = Q_res;
+
+        size_t bits = d.size() * 32;
+        while (!((d[(bits - 1) / 32] >> ((bits - 1) % 32)) & 1))
+        {
+            --bits;
+        }
+        for (size_t i = bits - 1; i-- > 0;)
+        {
+            U = ctx.multiply(U, V);
+            V = ctx.sub(ctx.square(V), ctx.add(Qk, Qk));
+            Qk = ctx.square(Qk);
+            if ((d[i / 32] >> (i % 32)) & 1)
+            {
+                Residue new_U = ctx.half(ctx.add(U, V));
+                V = ctx.half(ctx.add(ctx.multiply(D_res, U), V));
+                U = new_U;
+                Qk = ctx.multiply(Qk, Q_res);
+            }
+        }
+
+        const Residue zero = ctx.zero();
+        if (U == zero || V == zero)
+        {
+            return true;
+        }
+        for (size_t r = 1; r < s; r++)
+        {
+            V = ctx.sub(ctx.square(V), ctx.add(Qk, Qk));
+            Qk = ctx.square(Qk);
+            if (V == zero)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // n нечётно, не делится на малые простые и больше их квадрата
+    static bool probable_prime_after_sieve(const std::vector<unsigned long long> &n, unsigned rounds)
+    {
+        MontgomeryContext ctx(from_magnitude(n, false));
+        std::vector<uint32_t> n_minus_1 = to_binary_words(n);
+        n_minus_1[0] &= ~1u;
+        const size_t s = trailing_zero_bits(n_minus_1);
+        const std::vector<uint32_t> d = shift_right_words(n_minus_1, s);
+
+        if (!miller_rabin_round(ctx, ctx.add(ctx.one(), ctx.one()), d, s) || !strong_lucas_test(ctx, n))
+        {
+            return false;
+        }
+
+        static thread_local std::mt19937_64 rng(std::random_device{}());
+        for (unsigned round = 0; round < rounds; round++)
+        {
+            std::vector<unsigned long long> base(n.size() + 1);
+            for (unsigned long long &limb : base)
+            {
+                limb = rng() % DEFAULT_MODULE;
+            }
+            trim_magnitude(base);
+            std::vector<unsigned long long> rem;
+            divmod_magnitude(base, n, rem);
+            if (compare_magnitude(rem, {2}) < 0)
+            {
+                rem = {2};
+            }
+            if (!miller_rabin_round(ctx, ctx.to_montgomery(from_magnitude(rem, false)), d, s))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Деление 64-битного числа на фиксированный делитель d < module умножением на заранее
+    // вычисленное обратное floor((2^64 - 1) / d): частное получается с недостачей не больше 1
+    struct Reciprocal
+    {
+        unsigned long long divisor, inverse;
+
+        explicit Reciprocal(unsigned long long d) : divisor(d), inverse(d == 0 ? 0 : ~0ULL / d)
+        {
+            if (d == 0)
+            {
+                throw std::exception();
+            }
+        }
+
+        unsigned long long divide(unsigned long long n, unsigned long long &rem) const
+        {
+            unsigned long long q = (unsigned long long)(((uint128)n * inverse) >> 64);
+            rem = n - q * divisor;
+            if (rem >= divisor)
+            {
+                ++q;
+                rem -= divisor;
+            }
+            return q;
+        }
+    };
+
+    template <std::integral T>
+    static unsigned long long small_abs(T value)
+    {
+        if constexpr (std::is_signed_v<T>)
+        {
+            return value < 0 ? (unsigned long long)(-(value + 1)) + 1 : (unsigned long long)value;
+        }
+        else
+        {
+            return value;
+        }
+    }
+
+    static std::vector<unsigned long long> mul_1(const std::vector<unsigned long long> &a, unsigned long long m)
+    {
+        std::vector<unsigned long long> result = mul_small_magnitude(a, m);
+        trim_magnitude(result);
+        return result;
+    }
+
+    static std::vector<unsigned long long> divrem_1(const std::vector<unsigned long long> &a, const Reciprocal &d, unsigned long long &rem)
+    {
+        std::vector<unsigned long long> q(a.size());
+        rem = 0;
+        for (size_t i = 0; i < a.size(); i++)
+        {
+            q[i] = d.divide(rem * DEFAULT_MODULE + a[i], rem);
+        }
+        trim_magnitude(q);
+        return q;
+    }
+
+    static unsigned long long mod_1(const std::vector<unsigned long long> &a, const Reciprocal &d)
+    {
+        unsigned long long rem = 0;
+        for (unsigned long long limb : a)
+        {
+            d.divide(rem * DEFAULT_MODULE + limb, rem);
+        }
+        return rem;
+    }
+
+    std::vector<unsigned long long> divrem_small(unsigned long long d, unsigned long long &rem) const
+    {
+        if (d == 0)
+        {
+            throw std::exception();
+        }
+        if (d < DEFAULT_MODULE)
+        {
+            return divrem_1(magnitude(), Reciprocal(d), rem);
+        }
+        std::vector<unsigned long long> r;
+        std::vector<unsigned long long> q = divmod_magnitude(magnitude(), small_magnitude(d), r);
+        rem = 0;
+        for (unsigned long long limb : r)
+        {
+            rem = rem * DEFAULT_MODULE + limb;
+        }
+        return q;
+    }
+
+    // this + (negative ? -v : v)
+    BigInt add_small(bool negative, unsigned long long v) const
+    {
+        std::vector<unsigned long long> mag = magnitude();
+        const bool this_negative = is_negative();
+        if (this_negative == negative || v == 0)
+        {
+            unsigned long long carry = v;
+            for (size_t i = mag.size(); i-- > 0 && carry != 0;)
+            {
+                unsigned long long cur = mag[i] + carry % DEFAULT_MODULE;
+                mag[i] = cur % DEFAULT_MODULE;
+                carry = carry / DEFAULT_MODULE + cur / DEFAULT_MODULE;
+            }
+            if (carry != 0)
+            {
+                std::vector<unsigned long long> high = small_magnitude(carry);
+                mag.insert(mag.begin(), high.begin(), high.end());
+            }
+            return from_magnitude(std::move(mag), this_negative);
+        }
+
+        std::vector<unsigned long long> small = small_magnitude(v);
+        if (compare_magnitude(mag, small) < 0)
+        {
+            return from_magnitude(sub_magnitude(small, mag), negative);
+        }
+        unsigned long long borrow = 0;
+        for (size_t i = mag.size(); i-- > 0 && (v != 0 || borrow != 0);)
+        {
+            unsigned long long t = v % DEFAULT_MODULE + borrow;
+            v /= DEFAULT_MODULE;
+            borrow = mag[i] < t;
+            mag[i] = borrow ? mag[i] + DEFAULT_MODULE - t : mag[i] - t;
+        }
+        return from_magnitude(std::move(mag), this_negative);
+    }
+
+    // mag * 2^count: сдвиг кусками по 29 бит, чтобы множитель оставался одним разрядом
+    static std::vector<unsigned long long> shift_bits_left(std::vector<unsigned long long> mag, unsigned long long count)
+    {
+        for (; count >= 29; count -= 29)
+        {
+            mag = mul_1(mag, 1ULL << 29);
+        }
+        return count == 0 ? mag : mul_1(mag, 1ULL << count);
+    }
+
+    // mag / 2^count с округлением к ближайшему (половина - к чётному). Младшие куски отбрасываются
+    // первыми, от них нужен только признак ненулевого остатка; решает остаток последнего куска
+    static std::vector<unsigned long long> shift_bits_right_rounded(std::vector<unsigned long long> mag, unsigned long long count)
+    {
+        const unsigned long long last = count - (count - 1) / 29 * 29;
+        bool sticky = false;
+        unsigned long long rem = 0;
+        for (; count > last && !is_zero_magnitude(mag); count -= 29)
+        {
+            mag = divrem_1(mag, Reciprocal(1ULL << 29), rem);
+            sticky = sticky || rem != 0;
+        }
+        if (count > last)
+        {
+            return {0};
+        }
+        mag = divrem_1(mag, Reciprocal(1ULL << last), rem);
+        const unsigned long long half = 1ULL << (last - 1);
+        if (rem > half || (rem == half && (sticky || mag.back() % 2 == 1)))
+        {
+            mag = add_magnitude(mag, {1});
+        }
+        return mag;
+    }
+
+    // Величина сдвига должна помещаться в машинное слово
+    static unsigned long long shift_count(const BigInt &count)
+    {
+        const std::vector<unsigned long long> &mag = count.magnitude();
+        if (count.is_negative() || mag.size() > 2)
+        {
+            throw std::exception();
+        }
+        return mag.size() == 2 ? mag[0] * DEFAULT_MODULE + mag[1] : mag[0];
+    }
+
+    static constexpr size_t KARATSUBA_THRESHOLD = 32;
+    // Значащих битов в double и наибольшая длина (в разрядах) числа, ещё не переполняющего double
+    static constexpr int DOUBLE_MANTISSA_BITS = std::numeric_limits<double>::digits;
+    static constexpr size_t DOUBLE_MAX_LIMBS = std::numeric_limits<double>::max_exponent10 / 9 + 1;
+    // С этой длины короткого множителя (в разрядах) умножение идёт через БПФ
+    static constexpr size_t FFT_THRESHOLD = 2500;
+    static constexpr size_t FFT_MAX_PIECES = size_t(1) << 23;
+    // Размер буфера потокового вывода
+    static constexpr size_t STREAM_CHUNK = 1 << 14;
+    // Деление на закешированную степень по Барретту выгоднее столбика начиная с этой длины делителя
+    static constexpr size_t BARRETT_THRESHOLD = 32;
+    // Куски перевода не длиннее этого числа разрядов переводятся напрямую, за квадрат
+    static constexpr size_t CONVERSION_LEAF = 32;
+    static constexpr const char *DIGIT_CHARS = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    static unsigned digit_value(char c, unsigned base)
+    {
+        unsigned value = 36;
+        if (c >= '0' && c <= '9')
+        {
+            value = c - '0';
+        }
+        else if (c >= 'a' && c <= 'z')
+        {
+            value = c - 'a' + 10;
+        }
+        else if (c >= 'A' && c <= 'Z')
+        {
+            value = c - 'A' + 10;
+        }
+        if (value >= base)
+        {
+            throw std::exception();
+        }
+        return value;
+    }
+
+    // Наибольшая степень base, не превосходящая 2^32: столько цифр переводится за раз в машинном слове
+    static unsigned long long chunk_radix(unsigned base, unsigned &digits_per_chunk)
+    {
+        unsigned long long radix = base;
+        digits_per_chunk = 1;
+        while (radix * base <= (1ULL << 32))
+        {
+            radix *= base;
+            ++digits_per_chunk;
+        }
+        return radix;
+    }
+
+    static std::vector<unsigned long long> add_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+    {
+        const std::vector<unsigned long long> &longer = a.size() >= b.size() ? a : b;
+        const std::vector<unsigned long long> &shorter = a.size() >= b.size() ? b : a;
+        std::vector<unsigned long long> result(longer.size() + 1);
+        unsigned long long carry = 0;
+        for (size_t i = longer.size(), j = shorter.size(); i-- > 0;)
+        {
+            unsigned long long cur = longer[i] + carry + (j > 0 ? shorter[--j] : 0);
+            carry = cur >= DEFAULT_MODULE;
+            result[i + 1] = carry ? cur - DEFAULT_MODULE : cur;
+        }
+        result[0] = carry;
+        trim_magnitude(result);
+        return result;
+    }
+
+    // floor(a / module^count): отбрасывание младших разрядов
+    static std::vector<unsigned long long> drop_low_limbs(const std::vector<unsigned long long> &a, size_t count)
+    {
+        if (a.size() <= count)
+        {
+            return {0};
+        }
+        return std::vector<unsigned long long>(a.begin(), a.end() - count);
+    }
+
+    // Квадрат модуля: столбик, Карацуба на квадратах половин или БПФ с одним прямым преобразованием
+    static std::vector<unsigned long long> sqr_magnitude(const std::vector<unsigned long long> &a)
+    {
+        if (a.size() < KARATSUBA_THRESHOLD)
+        {
+            return sqr_schoolbook_magnitude(a);
+        }
+        if (a.size() >= FFT_THRESHOLD && fft_fits(a.size(), a.size()))
+        {
+            return fft_sqr_magnitude(a);
+        }
+        return karatsuba_sqr_magnitude(a);
+    }
+
+    // Сборщик умножения модулей: столбик для коротких, нарезка длинного множителя при
+    // сильной несбалансированности, БПФ для длинных, Toom-2.5 и Карацуба для остальных
+    static std::vector<unsigned long long> fast_mul_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+    {
+        const std::vector<unsigned long long> &longer = a.size() >= b.size() ? a : b;
+        const std::vector<unsigned long long> &shorter = a.size() >= b.size() ? b : a;
+        if (shorter.size() < KARATSUBA_THRESHOLD)
+        {
+            return mul_magnitude(longer, shorter);
+        }
+        if (longer.size() >= 2 * shorter.size())
+        {
+            return sliced_mul_magnitude(longer, shorter);
+        }
+        if (shorter.size() >= FFT_THRESHOLD && fft_fits(longer.size(), shorter.size()))
+        {
+            ProgressSteps steps(3);
+            steps.next();
+            const FftOperand prepared = fft_prepare(shorter, longer.size());
+            steps.next(2);
+            return fft_mul_magnitude(longer, prepared);
+        }
+        if (3 * longer.size() >= 4 * shorter.size())
+        {
+            return toom32_magnitude(longer, shorter);
+        }
+        return karatsuba_magnitude(longer, shorter);
+    }
+
+    // Разбиение x = high * module^m + low
+    static void split_magnitude(const std::vector<unsigned long long> &x, size_t m, std::vector<unsigned long long> &high, std::vector<unsigned long long> &low)
+    {
+        if (x.size() <= m)
+        {
+            high = {0};
+            low = x;
+            return;
+        }
+        high.assign(x.begin(), x.end() - m);
+        low.assign(x.end() - m, x.end());
+        trim_magnitude(low);
+    }
+
+    // Карацуба для операндов близкой длины
+    static std::vector<unsigned long long> karatsuba_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+    {
+        if (std::min(a.size(), b.size()) < KARATSUBA_THRESHOLD)
+        {
+            return mul_magnitude(a, b);
+        }
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_karatsuba, a.size() + b.size());
+        const size_t m = std::max(a.size(), b.size()) / 2;
+        std::vector<unsigned long long> a1, a0, b1, b0;
+        split_magnitude(a, m, a1, a0);
+        split_magnitude(b, m, b1, b0);
+
+        ProgressSteps steps(3);
+        steps.next();
+        std::vector<unsigned long long> high = fast_mul_magnitude(a1, b1);
+        steps.next();
+        std::vector<unsigned long long> low = fast_mul_magnitude(a0, b0);
+        steps.next();
+        std::vector<unsigned long long> middle = fast_mul_magnitude(add_magnitude(a1, a0), add_magnitude(b1, b0));
+        middle = sub_magnitude(sub_magnitude(middle, high), low);
+        return add_magnitude(add_magnitude(shift_magnitude(high, 2 * m), shift_magnitude(middle, m)), low);
+    }
+
+    // (a1 * B + a0)^2 = a1^2 * B^2 + ((a1 + a0)^2 - a1^2 - a0^2) * B + a0^2
+    static std::vector<unsigned long long> karatsuba_sqr_magnitude(const std::vector<unsigned long long> &a)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_karatsuba, 2 * a.size());
+        const size_t m = a.size() / 2;
+        std::vector<unsigned long long> a1, a0;
+        split_magnitude(a, m, a1, a0);
+
+        ProgressSteps steps(3);
+        steps.next();
+        std::vector<unsigned long long> high = sqr_magnitude(a1);
+        steps.next();
+        std::vector<unsigned long long> low = sqr_magnitude(a0);
+        steps.next();
+        std::vector<unsigned long long> middle = sqr_magnitude(add_magnitude(a1, a0));
+        middle = sub_magnitude(sub_magnitude(middle, high), low);
+        return add_magnitude(add_magnitude(shift_magnitude(high, 2 * m), shift_magnitude(middle, m)), low);
+    }
+
+    // Toom-2.5 (Toom-32) для отношения длин от 4/3 до 2: a - три куска, b - два, четыре умножения
+    // в точках 0, 1, -1, бесконечность вместо шести
+    static std::vector<unsigned long long> toom32_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_toom32, a.size() + b.size());
+        const size_t k = std::max((a.size() + 2) / 3, (b.size() + 1) / 2);
+        std::vector<unsigned long long> a2, a1, a0, rest, b1, b0;
+        split_magnitude(a, k, rest, a0);
+        split_magnitude(rest, k, a2, a1);
+        split_magnitude(b, k, b1, b0);
+
+        auto mul = [](const BigInt &x, const BigInt &y)
+        {
+            return from_magnitude(fast_mul_magnitude(x.magnitude(), y.magnitude()), x.is_negative() != y.is_negative());
+        };
+        const BigInt A0 = from_magnitude(a0, false), A1 = from_magnitude(a1, false), A2 = from_magnitude(a2, false);
+        const BigInt B0 = from_magnitude(b0, false), B1 = from_magnitude(b1, false);
+        const BigInt A02 = A0 + A2;
+
+        ProgressSteps steps(4);
+        steps.next();
+        const BigInt w0 = mul(A0, B0);
+        steps.next();
+        const BigInt w_inf = mul(A2, B1);
+        steps.next();
+        const BigInt w1 = mul(A02 + A1, B0 + B1);
+        steps.next();
+        const BigInt w_m1 = mul(A02 - A1, B0 - B1);
+
+        // w1 = c0 + c1 + c2 + c3, w_m1 = c0 - c1 + c2 - c3
+        const BigInt c2 = (w1 + w_m1) / 2 - w0;
+        const BigInt c1 = (w1 - w_m1) / 2 - w_inf;
+
+        std::vector<unsigned long long> result = add_magnitude(shift_magnitude(w_inf.magnitude(), 3 * k), shift_magnitude(c2.magnitude(), 2 * k));
+        result = add_magnitude(result, shift_magnitude(c1.magnitude(), k));
+        return add_magnitude(result, w0.magnitude());
+    }
+
+    // acc += x * module^shift; acc заранее имеет достаточную длину
+    static void add_shifted(std::vector<unsigned long long> &acc, const std::vector<unsigned long long> &x, size_t shift)
+    {
+        unsigned long long carry = 0;
+        size_t pos = acc.size() - shift;
+        for (size_t j = x.size(); j-- > 0;)
+        {
+            unsigned long long cur = acc[--pos] + x[j] + carry;
+            carry = cur >= DEFAULT_MODULE;
+            acc[pos] = carry ? cur - DEFAULT_MODULE : cur;
+        }
+        while (carry != 0)
+        {
+            unsigned long long cur = acc[--pos] + carry;
+            carry = cur >= DEFAULT_MODULE;
+            acc[pos] = carry ? cur - DEFAULT_MODULE : cur;
+        }
+    }
+
+    // Длинный множитель режется на куски длины короткого; спектр короткого при умножении
+    // через БПФ считается один раз на все куски
+    static std::vector<unsigned long long> sliced_mul_magnitude(const std::vector<unsigned long long> &longer, const std::vector<unsigned long long> &shorter, bool prefer_fft = false)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_sliced, longer.size() + shorter.size());
+        const size_t len = shorter.size();
+        std::vector<unsigned long long> result(longer.size() + len, 0);
+        const bool use_fft = (prefer_fft || len >= FFT_THRESHOLD) && fft_fits(len, len);
+        ProgressSteps steps((longer.size() + len - 1) / len * 2 + 1);
+        steps.next();
+        FftOperand prepared;
+        if (use_fft)
+        {
+            prepared = fft_prepare(shorter, len);
+        }
+        for (size_t low = 0; low < longer.size(); low += len)
+        {
+            steps.next(2);
+            const size_t high = std::min(longer.size(), low + len);
+            std::vector<unsigned long long> chunk(longer.end() - high, longer.end() - low);
+            trim_magnitude(chunk);
+            if (is_zero_magnitude(chunk))
+            {
+                continue;
+            }
+            add_shifted(result, use_fft ? fft_mul_magnitude(chunk, prepared) : fast_mul_magnitude(chunk, shorter), low);
+        }
+        trim_magnitude(result);
+        return result;
+    }
+
+    // Спектр множителя, разложенного по основанию 1000; пригоден для второго множителя длиной до other_size разрядов
+    struct FftOperand
+    {
+        size_t pieces = 0;
+        std::vector<std::complex<double>> spectrum;
+    };
+
+    // Коэффициенты свёртки не превосходят pieces * 10^6; на большей длине погрешность double
+    // уже мешает округлению, и такие произведения сначала дробятся Карацубой
+    static bool fft_fits(size_t a_size, size_t b_size)
+    {
+        return 3 * (a_size + b_size) <= FFT_MAX_PIECES;
+    }
+
+    static std::vector<std::complex<double>> fft_pieces(const std::vector<unsigned long long> &x, size_t n)
+    {
+        std::vector<std::complex<double>> pieces(n);
+        size_t k = 0;
+        for (size_t i = x.size(); i-- > 0;)
+        {
+            pieces[k++] = (double)(x[i] % 1000);
+            pieces[k++] = (double)(x[i] / 1000 % 1000);
+            pieces[k++] = (double)(x[i] / 1000000);
+        }
+        return pieces;
+    }
+
+    static FftOperand fft_prepare(const std::vector<unsigned long long> &x, size_t other_size)
+    {
+        size_t n = 1;
+        while (n < 3 * (x.size() + other_size))
+        {
+            n <<= 1;
+        }
+        FftOperand result{3 * x.size(), fft_pieces(x, n)};
+        fft_transform(result.spectrum, false);
+        return result;
+    }
+
+    static std::vector<unsigned long long> fft_mul_magnitude(const std::vector<unsigned long long> &a, const FftOperand &b)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_fft, a.size() + b.pieces / 3);
+        const size_t n = b.spectrum.size();
+        std::vector<std::complex<double>> fa = fft_pieces(a, n);
+        ProgressSteps steps(2);
+        steps.next();
+        fft_transform(fa, false);
+        for (size_t i = 0; i < n; i++)
+        {
+            fa[i] *= b.spectrum[i];
+        }
+        steps.next();
+        fft_transform(fa, true);
+        return fft_collect(fa, 3 * a.size() + b.pieces);
+    }
+
+    // Квадрат: спектр один, прямое преобразование тоже одно
+    static std::vector<unsigned long long> fft_sqr_magnitude(const std::vector<unsigned long long> &a)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_fft, 2 * a.size());
+        size_t n = 1;
+        while (n < 6 * a.size())
+        {
+            n <<= 1;
+        }
+        std::vector<std::complex<double>> fa = fft_pieces(a, n);
+        ProgressSteps steps(2);
+        steps.next();
+        fft_transform(fa, false);
+        for (std::complex<double> &x : fa)
+        {
+            x *= x;
+        }
+        steps.next();
+        fft_transform(fa, true);
+        return fft_collect(fa, 6 * a.size());
+    }
+
+    // Округление count коэффициентов обратного преобразования и перенос по основанию 1000
+    static std::vector<unsigned long long> fft_collect(const std::vector<std::complex<double>> &fa, size_t count)
+    {
+        std::vector<unsigned long long> result((count + 2) / 3 + 1, 0);
+        unsigned long long carry = 0, scale[3] = {1, 1000, 1000000};
+        for (size_t i = 0; i < count || carry != 0; i++)
+        {
+            carry += i < count ? (unsigned long long)std::llround(fa[i].real()) : 0;
+            result[result.size() - 1 - i / 3] += carry % 1000 * scale[i % 3];
+            carry /= 1000;
+        }
+        trim_magnitude(result);
+        return result;
+    }
+
+    // Итеративное БПФ; корни каждого уровня считаются напрямую, а не накоплением произведений
+    static void fft_transform(std::vector<std::complex<double>> &a, bool invert)
+    {
+        const size_t n = a.size();
+        for (size_t i = 1, j = 0; i < n; i++)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j)
+            {
+                std::swap(a[i], a[j]);
+            }
+        }
+        std::vector<std::complex<double>> roots;
+        const double passes = (double)std::bit_width(n);
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            progress_point((double)std::bit_width(len / 2) / passes);
+            const double angle = 2 * (double)PI / (double)len * (invert ? -1 : 1);
+            roots.resize(len / 2);
+            for (size_t k = 0; k < len / 2; k++)
+            {
+                roots[k] = std::polar(1.0, angle * (double)k);
+            }
+            for (size_t i = 0; i < n; i += len)
+            {
+                for (size_t k = 0; k < len / 2; k++)
+                {
+                    std::complex<double> u = a[i + k], v = a[i + k + len / 2] * roots[k];
+                    a[i + k] = u + v;
+                    a[i + k + len / 2] = u - v;
+                }
+            }
+        }
+        if (invert)
+        {
+            for (std::complex<double> &x : a)
+            {
+                x /= (double)n;
+            }
+        }
+    }
+
+    // Произведение, в котором гарантированно учтены все пары разрядов a_i * b_j (номера с младшего)
+    // с lo <= i + j < hi; остальные пары могут как учитываться, так и отбрасываться.
+    // Пары выше hi делятся на module^hi, пары ниже lo дают в сумме меньше min(|a|, |b|) * module^(lo + 1)
+    static std::vector<unsigned long long> band_product(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b, size_t lo, size_t hi)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::mul_truncated, a.size() + b.size());
+        const size_t la = a.size(), lb = b.size();
+        if (hi == 0 || la + lb - 2 < lo || is_zero_magnitude(a) || is_zero_magnitude(b))
+        {
+            return {0};
+        }
+        // На уровне FFT усечение не окупается: полное произведение стоит почти столько же, сколько его половина
+        if ((lo == 0 && hi >= la + lb - 1) || (std::min(la, lb) >= FFT_THRESHOLD && fft_fits(std::max(la, lb), std::min(la, lb))))
+        {
+            return fast_mul_magnitude(a, b);
+        }
+        if (std::min(la, lb) < KARATSUBA_THRESHOLD)
+        {
+            std::vector<unsigned long long> acc(la + lb + 1, 0); // младший первым
+            for (size_t i = 0; i < la; i++)
+            {
+                const unsigned long long ai = a[la - 1 - i];
+                size_t j = lo > i ? lo - i : 0;
+                const size_t j_end = std::min(lb, hi > i ? hi - i : 0);
+                if (ai == 0 || j >= j_end)
+                {
+                    continue;
+                }
+                unsigned long long carry = 0;
+                for (; j < j_end; j++)
+                {
+                    unsigned long long cur = acc[i + j] + ai * b[lb - 1 - j] + carry;
+                    acc[i + j] = cur % DEFAULT_MODULE;
+                    carry = cur / DEFAULT_MODULE;
+                }
+                for (size_t pos = i + j_end; carry != 0; pos++)
+                {
+                    unsigned long long cur = acc[pos] + carry;
+                    acc[pos] = cur % DEFAULT_MODULE;
+                    carry = cur / DEFAULT_MODULE;
+                }
+            }
+            std::reverse(acc.begin(), acc.end());
+            trim_magnitude(acc);
+            return acc;
+        }
+
+        // Те же четыре части, что у Карацубы, но каждая со своим сдвинутым окном столбцов;
+        // части, целиком лежащие вне окна, не вычисляются
+        const size_t k = std::max(la, lb) / 2;
+        std::vector<unsigned long long> a1, a0, b1, b0;
+        split_magnitude(a, k, a1, a0);
+        split_magnitude(b, k, b1, b0);
+        auto below = [lo](size_t shift)
+        {
+            return lo > shift ? lo - shift : 0;
+        };
+        ProgressSteps steps(3);
+        steps.next();
+        std::vector<unsigned long long> result = band_product(a0, b0, lo, hi);
+        steps.next();
+        if (hi > k)
+        {
+            std::vector<unsigned long long> middle = add_magnitude(band_product(a1, b0, below(k), hi - k), band_product(a0, b1, below(k), hi - k));
+            result = add_magnitude(result, shift_magnitude(middle, k));
+        }
+        steps.next();
+        if (hi > 2 * k)
+        {
+            result = add_magnitude(result, shift_magnitude(band_product(a1, b1, below(2 * k), hi - 2 * k), 2 * k));
+        }
+        return result;
+    }
+
+    // a mod module^n
+    static std::vector<unsigned long long> low_limbs(const std::vector<unsigned long long> &a, size_t n)
+    {
+        if (a.size() <= n)
+        {
+            return a;
+        }
+        std::vector<unsigned long long> result(a.end() - n, a.end());
+        trim_magnitude(result);
+        return result;
+    }
+
+    // a * b mod module^n: столбцы от n и выше не считаются
+    static std::vector<unsigned long long> mul_low_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b, size_t n)
+    {
+        if (n == 0)
+        {
+            return {0};
+        }
+        return low_limbs(band_product(low_limbs(a, n), low_limbs(b, n), 0, n), n);
+    }
+
+    // floor(a * b / module^n) с недостачей не больше единицы: столбцы ниже n - 2 не считаются
+    static std::vector<unsigned long long> mul_high_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b, size_t n)
+    {
+        return drop_low_limbs(band_product(a, b, n >= 2 ? n - 2 : 0, SIZE_MAX), n);
+    }
+
+    // Разряды [lo, hi) произведения; погрешность младшего - как у mul_high_magnitude
+    static std::vector<unsigned long long> mul_middle_magnitude(const std::vector<unsigned long long> &a, const std::vector<unsigned long long> &b, size_t lo, size_t hi)
+    {
+        if (hi <= lo)
+        {
+            return {0};
+        }
+        return low_limbs(drop_low_limbs(band_product(a, b, lo >= 2 ? lo - 2 : 0, hi), lo), hi - lo);
+    }
+
+    // module^k - d * r по младшим len разрядам произведения; верно, если |module^k - d * r| < module^len / 2
+    static std::vector<unsigned long long> power_defect(const std::vector<unsigned long long> &d, const std::vector<unsigned long long> &r, size_t len, bool &negative)
+    {
+        std::vector<unsigned long long> low = mul_low_magnitude(d, r, len);
+        negative = false;
+        if (is_zero_magnitude(low))
+        {
+            return low;
+        }
+        if (compare_magnitude(low, shift_magnitude({DEFAULT_MODULE / 2}, len - 1)) < 0)
+        {
+            negative = true;
+            return low;
+        }
+        return sub_magnitude(shift_magnitude({1}, len), low);
+    }
+
+    // floor(module^k / d) методом Ньютона: обратное к старшей половине, один шаг уточнения
+    // и точная поправка на несколько единиц. Известно, что d * r близко к module^k, поэтому
+    // от произведений нужны только младшие (d * r) или старшие (r * e) разряды
+    static std::vector<unsigned long long> inverse_magnitude(const std::vector<unsigned long long> &d, size_t k)
+    {
+        const size_t n = d.size();
+        if (k < n)
+        {
+            return {0};
+        }
+        const size_t p = k - n;
+        if (n <= BARRETT_THRESHOLD || p <= BARRETT_THRESHOLD)
+        {
+            std::vector<unsigned long long> rem;
+            return divmod_magnitude(shift_magnitude({1}, k), d, rem);
+        }
+
+        const size_t h = p / 2 + 1, t = std::min(n, h + 2);
+        const std::vector<unsigned long long> d_top(d.begin(), d.begin() + t);
+        // Рекурсия на половинной точности стоит примерно столько же, сколько этот шаг
+        ProgressSteps steps(4);
+        steps.next(2);
+        std::vector<unsigned long long> r = shift_magnitude(inverse_magnitude(d_top, t + h), p - h);
+
+        // r += r * e / module^k, e = module^k - d * r, |e| < module^(k - h)
+        bool negative = false;
+        steps.next();
+        std::vector<unsigned long long> e = power_defect(d, r, k - h + 2, negative);
+        steps.next();
+        std::vector<unsigned long long> correction = mul_high_magnitude(r, e, k);
+        if (!negative)
+        {
+            r = add_magnitude(r, correction);
+        }
+        else
+        {
+            correction = add_magnitude(correction, {2});
+            r = compare_magnitude(r, correction) > 0 ? sub_magnitude(r, correction) : std::vector<unsigned long long>{0};
+        }
+
+        // Остаток module^k - d * r теперь меньше нескольких d по модулю
+        std::vector<unsigned long long> rem = power_defect(d, r, n + 2, negative);
+        while (negative)
+        {
+            r = sub_magnitude(r, {1});
+            if (compare_magnitude(rem, d) <= 0)
+            {
+                rem = sub_magnitude(d, rem);
+                negative = false;
+            }
+            else
+            {
+                rem = sub_magnitude(rem, d);
+            }
+        }
+        while (compare_magnitude(rem, d) >= 0)
+        {
+            r = add_magnitude(r, {1});
+            rem = sub_magnitude(rem, d);
+        }
+        return r;
+    }
+
+    // radix^(2^level) и, по требованию, обратное к нему для деления по Барретту
+    struct RadixPower
+    {
+        std::vector<unsigned long long> power, inverse;
+    };
+
+    // Степени кешируются по потокам; deque не двигает уже выданные элементы
+    static std::deque<RadixPower> &radix_powers(unsigned long long radix, size_t levels)
+    {
+        static thread_local std::map<unsigned long long, std::deque<RadixPower>> cache;
+        std::deque<RadixPower> &powers = cache[radix];
+        if (powers.empty())
         {
-            return a * b;
+            powers.push_back({small_magnitude(radix), {}});
         }
-        else
+        while (powers.size() < levels)
+        {
+            powers.push_back({fast_mul_magnitude(powers.back().power, powers.back().power), {}});
+        }
+        return powers;
+    }
+
+    // Частное и остаток от деления x < P^2 на закешированную степень P
+    static std::vector<unsigned long long> divmod_power(const std::vector<unsigned long long> &x, RadixPower &p, std::vector<unsigned long long> &rem)
+    {
+        if (p.power.size() >= BARRETT_THRESHOLD && p.inverse.empty())
+        {
+            p.inverse = barrett_inverse(p.power);
+        }
+        return barrett_divmod(x, p.power, p.inverse, rem);
+    }
+
+    static std::vector<unsigned long long> barrett_inverse(const std::vector<unsigned long long> &d)
+    {
+        return d.size() >= BARRETT_THRESHOLD ? inverse_magnitude(d, 2 * d.size()) : std::vector<unsigned long long>();
+    }
+
+    // Деление x < d^2 по Барретту с inverse = barrett_inverse(d); для коротких d - столбиком
+    static std::vector<unsigned long long> barrett_divmod(const std::vector<unsigned long long> &x, const std::vector<unsigned long long> &d, const std::vector<unsigned long long> &inverse, std::vector<unsigned long long> &rem)
+    {
+        BIGINT_TELEMETRY_SCOPE(TelemetryOp::div_barrett, x.size() + d.size());
+        const size_t n = d.size();
+        if (inverse.empty() || x.size() > 2 * n)
+        {
+            return divmod_magnitude(x, d, rem);
+        }
+        std::vector<unsigned long long> q = mul_high_magnitude(drop_low_limbs(x, n - 1), inverse, n + 1);
+        // Остаток x - q * d меньше 4d < module^(n + 1), его дают младшие n + 1 разрядов
+        std::vector<unsigned long long> x_low = low_limbs(x, n + 1), qd_low = mul_low_magnitude(q, d, n + 1);
+        rem = compare_magnitude(x_low, qd_low) >= 0 ? sub_magnitude(x_low, qd_low) : sub_magnitude(add_magnitude(x_low, shift_magnitude({1}, n + 1)), qd_low);
+        while (compare_magnitude(rem, d) >= 0)
+        {
+            rem = sub_magnitude(rem, d);
+            q = add_magnitude(q, {1});
+        }
+        return q;
+    }
+
+    // Цифры по основанию radix <= 2^32, младшая первой: x делится пополам на radix^(2^level)
+    static std::vector<unsigned long long> magnitude_to_chunks(const std::vector<unsigned long long> &x, unsigned long long radix)
+    {
+        size_t level = 0;
+        std::deque<RadixPower> *powers = &radix_powers(radix, 1);
+        while (compare_magnitude((*powers)[level].power, x) <= 0)
         {
-            const size_t m = std::min(a.digits.size(), b.digits.size()) / 2;
+            powers = &radix_powers(radix, ++level + 1);
+        }
+        std::vector<unsigned long long> chunks(size_t(1) << level, 0);
+        emit_chunks(x, radix, *powers, level, chunks.data());
+        while (chunks.size() > 1 && chunks.back() == 0)
+        {
+            chunks.pop_back();
+        }
+        return chunks;
+    }
 
-            BigInt a_part1, a_part2;
-            if (a.digits.size() > m)
+    // x < radix^(2^level) записывается в out[0 .. 2^level)
+    static void emit_chunks(const std::vector<unsigned long long> &x, unsigned long long radix, std::deque<RadixPower> &powers, size_t level, unsigned long long *out)
+    {
+        if (is_zero_magnitude(x))
+        {
+            return;
+        }
+        if (x.size() <= CONVERSION_LEAF || level == 0)
+        {
+            std::vector<unsigned long long> q = x;
+            for (size_t i = 0; !is_zero_magnitude(q); i++)
             {
-                a_part1.digits.assign(a.digits.begin(), a.digits.begin() + (a.digits.size() - m));
-                a_part2.digits.assign(a.digits.begin() + (a.digits.size() - m), a.digits.end());
+                unsigned long long rem = 0;
+                for (unsigned long long &limb : q)
+                {
+                    unsigned long long cur = rem * DEFAULT_MODULE + limb;
+                    limb = cur / radix;
+                    rem = cur % radix;
+                }
+                trim_magnitude(q);
+                out[i] = rem;
             }
-            else
+            return;
+        }
+        std::vector<unsigned long long> rem;
+        std::vector<unsigned long long> q = divmod_power(x, powers[level - 1], rem);
+        emit_chunks(rem, radix, powers, level - 1, out);
+        emit_chunks(q, radix, powers, level - 1, out + (size_t(1) << (level - 1)));
+    }
+
+    // Обратный перевод: старшая половина цифр умножается на закешированную степень radix
+    static std::vector<unsigned long long> chunks_to_magnitude(const std::vector<unsigned long long> &chunks, unsigned long long radix)
+    {
+        size_t level = 0;
+        while ((size_t(1) << level) < chunks.size())
+        {
+            ++level;
+        }
+        std::deque<RadixPower> &powers = radix_powers(radix, std::max<size_t>(level, 1));
+        return collect_chunks(chunks, radix, powers, 0, level);
+    }
+
+    static std::vector<unsigned long long> collect_chunks(const std::vector<unsigned long long> &chunks, unsigned long long radix, std::deque<RadixPower> &powers, size_t pos, size_t level)
+    {
+        const size_t count = size_t(1) << level;
+        if (pos >= chunks.size())
+        {
+            return {0};
+        }
+        if (count <= CONVERSION_LEAF)
+        {
+            // Схема Горнера; radix может быть больше module, поэтому перенос бывает в несколько разрядов
+            std::vector<unsigned long long> result;
+            for (size_t i = std::min(chunks.size(), pos + count); i-- > pos;)
             {
-                a_part2 = a;
+                unsigned long long carry = chunks[i];
+                for (size_t j = result.size(); j-- > 0;)
+                {
+                    unsigned long long cur = result[j] * radix + carry;
+                    result[j] = cur % DEFAULT_MODULE;
+                    carry = cur / DEFAULT_MODULE;
+                }
+                for (; carry != 0; carry /= DEFAULT_MODULE)
+                {
+                    result.insert(result.begin(), carry % DEFAULT_MODULE);
+                }
             }
+            trim_magnitude(result);
+            return result;
+        }
+        std::vector<unsigned long long> low = collect_chunks(chunks, radix, powers, pos, level - 1);
+        std::vector<unsigned long long> high = collect_chunks(chunks, radix, powers, pos + count / 2, level - 1);
+        return add_magnitude(fast_mul_magnitude(high, powers[level - 1].power), low);
+    }
+
+#ifdef BIGINT_TELEMETRY
+    // Счётчики одного потока. Пишет только сам поток (relaxed, без блокировок), читает снимок;
+    // при завершении потока счётчики переносятся в общий итог
+    struct TelemetryThread
+    {
+        struct Atomic
+        {
+            std::atomic<uint64_t> calls{0}, limbs{0}, allocations{0}, nanoseconds{0};
+        };
+
+        std::array<Atomic, (size_t)TelemetryOp::count> counters;
+
+        TelemetryThread()
+        {
+            TelemetryRegistry &registry = telemetry_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            registry.threads.push_back(this);
+        }
+
+        ~TelemetryThread()
+        {
+            TelemetryRegistry &registry = telemetry_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            add_to(registry.retired);
+            std::erase(registry.threads, this);
+        }
+
+        static void bump(std::atomic<uint64_t> &counter, uint64_t delta)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
 
-            BigInt b_part1, b_part2;
-            if (b.digits.size() > m)
+        void add_to(TelemetrySnapshot &snapshot) const
+        {
+            for (size_t i = 0; i < counters.size(); i++)
             {
-                b_part1.digits.assign(b.digits.begin(), b.digits.begin() + (b.digits.size() - m));
-                b_part2.digits.assign(b.digits.begin() + (b.digits.size() - m), b.digits.end());
+                snapshot._counters[i].calls += counters[i].calls.load(std::memory_order_relaxed);
+                snapshot._counters[i].limbs += counters[i].limbs.load(std::memory_order_relaxed);
+                snapshot._counters[i].allocations += counters[i].allocations.load(std::memory_order_relaxed);
+                snapshot._counters[i].nanoseconds += counters[i].nanoseconds.load(std::memory_order_relaxed);
             }
-            else
+        }
+
+        void reset()
+        {
+            for (Atomic &c : counters)
             {
-                b_part2 = b;
+                c.calls.store(0, std::memory_order_relaxed);
+                c.limbs.store(0, std::memory_order_relaxed);
+                c.allocations.store(0, std::memory_order_relaxed);
+                c.nanoseconds.store(0, std::memory_order_relaxed);
             }
+        }
+    };
+
+    struct TelemetryRegistry
+    {
+        std::mutex mutex;
+        std::vector<TelemetryThread *> threads;
+        TelemetrySnapshot retired;
+    };
+
+    // Реестр не разрушается: потоки могут завершаться и после статических деструкторов
+    static TelemetryRegistry &telemetry_registry()
+    {
+        static TelemetryRegistry *registry = new TelemetryRegistry();
+        return *registry;
+    }
 
-            BigInt prod_of_second_parts = a_part2.karatsuba_multiply(b_part2);
-            BigInt sumOfAParts = a_part1 + a_part2;
-            BigInt sumOfBParts = b_part1 + b_part2;
-            BigInt prod_of_sums_of_parts = sumOfAParts.karatsuba_multiply(sumOfBParts);
-            BigInt prod_of_first_parts = a_part1.karatsuba_multiply(b_part1);
+    static TelemetryThread &telemetry_thread()
+    {
+        thread_local TelemetryThread counters;
+        return counters;
+    }
+
+    // Выделения памяти этим потоком; замена operator new только увеличивает число
+    static inline thread_local uint64_t telemetry_allocations = 0;
+
+    // Замер от создания до конца блока
+    class TelemetryScope
+    {
+    public:
+        TelemetryScope(TelemetryOp op, size_t limbs)
+            : _counters(telemetry_thread().counters[(size_t)op]), _allocations(telemetry_allocations), _start(std::chrono::steady_clock::now())
+        {
+            TelemetryThread::bump(_counters.calls, 1);
+            TelemetryThread::bump(_counters.limbs, limbs);
+        }
+
+        TelemetryScope(const TelemetryScope &) = delete;
+        TelemetryScope &operator=(const TelemetryScope &) = delete;
 
-            BigInt sum_of_middle_terms = prod_of_sums_of_parts - prod_of_first_parts - prod_of_second_parts;
+        ~TelemetryScope()
+        {
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start);
+            TelemetryThread::bump(_counters.nanoseconds, (uint64_t)elapsed.count());
+            TelemetryThread::bump(_counters.allocations, telemetry_allocations - _allocations);
+        }
+
+    private:
+        TelemetryThread::Atomic &_counters;
+        uint64_t _allocations;
+        std::chrono::steady_clock::time_point _start;
+    };
+#endif
+
+    // Состояние асинхронного вычисления в его потоке: токен остановки, получатель прогресса
+    // и отрезок [begin, begin + width) общей доли, который покрывает текущий уровень рекурсии
+    struct AsyncControl
+    {
+        std::stop_token stop;
+        ProgressCallback progress;
+        double begin = 0, width = 1, reported = 0;
 
-            for (size_t i = 0; i < 2 * m; i++)
+        // Проверка отмены и отчёт о доле fraction текущего отрезка; мелкие приращения не сообщаются
+        void checkpoint(double fraction)
+        {
+            if (stop.stop_requested())
             {
-                prod_of_first_parts.digits.push_back(0);
+                throw Cancelled();
             }
-
-            for (size_t i = 0; i < m; i++)
+            const double done = begin + width * fraction;
+            if (progress && done >= reported + 0.001)
             {
-                sum_of_middle_terms.digits.push_back(0);
+                reported = done;
+                progress(done);
             }
-
-            result = prod_of_first_parts + sum_of_middle_terms + prod_of_second_parts;
         }
+    };
 
-        return result;
-    }
+    static inline thread_local AsyncControl *async_control = nullptr;
 
-    BigInt newton_divide(const BigInt &a) const
+    // Точка проверки внутри плоского цикла; вне асинхронного вычисления ничего не делает
+    static void progress_point(double fraction)
     {
-        if (a.digits.front() == 0)
+        if (async_control != nullptr)
         {
-            throw std::exception();
+            async_control->checkpoint(fraction);
         }
-        return BigInt(newton_divide_mas(this->digits, a.digits).first);
     }
 
-    static std::pair<std::vector<unsigned long long>, std::vector<unsigned long long>> newton_divide_mas(const std::vector<unsigned long long> &f, const std::vector<unsigned long long> &g)
+    // Текущий отрезок работы, разбитый на count равных единиц: next(parts) закрывает предыдущую
+    // часть и открывает следующую длиной parts единиц. Начало каждой части - точка проверки отмены,
+    // точки внутри неё отсчитываются от её границ; деструктор возвращает отрезок целиком
+    class ProgressSteps
     {
-        if (f.size() < g.size())
+    public:
+        explicit ProgressSteps(size_t count) : _control(async_control), _count((double)count)
         {
-            return {std::vector<unsigned long long>(1, 0), std::vector<unsigned long long>(f)};
+            if (_control != nullptr)
+            {
+                _begin = _control->begin;
+                _width = _control->width;
+            }
+        }
+
+        ProgressSteps(const ProgressSteps &) = delete;
+        ProgressSteps &operator=(const ProgressSteps &) = delete;
+
+        void next(size_t parts = 1)
+        {
+            if (_control == nullptr)
+            {
+                return;
+            }
+            restore();
+            _control->checkpoint(_done / _count);
+            _control->begin = _begin + _width * _done / _count;
+            _control->width = _width * (double)parts / _count;
+            _done += (double)parts;
+        }
+
+        ~ProgressSteps()
+        {
+            if (_control != nullptr)
+            {
+                restore();
+            }
         }
-        int m = f.size() - g.size();
-        std::vector<unsigned long long> h = newton_inverse(rev(g, g.size()), m + 1);
-        std::vector<unsigned long long> q = (((BigInt(rev(f, f.size())) * BigInt(h)))).digits;
-        if(q.size() >= (size_t)(m + 1)){
-            q = {q.begin() + q.size() - m - 1, q.end()};
+
+    private:
+        void restore()
+        {
+            _control->begin = _begin;
+            _control->width = _width;
         }
-        return {rev(q, m), (BigInt(f) - (BigInt(rev(q, m)) * BigInt(g))).digits};
+
+        AsyncControl *_control;
+        double _count, _done = 0, _begin = 0, _width = 0;
+    };
+
+    // Оборачивает работу: ставит AsyncControl на время вычисления и сообщает 1 по завершении
+    static std::function<BigInt()> controlled(std::function<BigInt()> work, std::stop_token stop, ProgressCallback progress)
+    {
+        return [work = std::move(work), stop = std::move(stop), progress = std::move(progress)]() mutable
+        {
+            AsyncControl control{stop, std::move(progress)};
+            struct Restore
+            {
+                AsyncControl *outer;
+                ~Restore()
+                {
+                    async_control = outer;
+                }
+            } restore{std::exchange(async_control, &control)};
+
+            control.checkpoint(0);
+            BigInt result = work();
+            if (control.progress)
+            {
+                control.progress(1.0);
+            }
+            return result;
+        };
     }
 
-    static std::vector<unsigned long long> rev(const std::vector<unsigned long long> &vec, size_t n)
+    template <typename Executor>
+    static std::future<BigInt> launch(Executor &executor, std::function<BigInt()> task)
     {
-        std::vector<unsigned long long> result = vec;
+        auto packaged = std::make_shared<std::packaged_task<BigInt()>>(std::move(task));
+        std::future<BigInt> result = packaged->get_future();
+        executor(std::function<void()>([packaged]()
+                                       { (*packaged)(); }));
+        return result;
+    }
 
-        size_t elements_to_reverse = std::min(n, result.size());
+    std::function<BigInt()> multiply_work(const BigInt &other) const
+    {
+        return [a = *this, b = other]()
+        {
+            return from_magnitude(fast_mul_magnitude(a.magnitude(), b.magnitude()), a.is_negative() != b.is_negative());
+        };
+    }
 
-        std::reverse(result.begin(), result.begin() + elements_to_reverse);
+    std::function<BigInt()> divide_work(const BigInt &other) const
+    {
+        return [a = *this, b = other]()
+        {
+            return a.newton_divide(b);
+        };
+    }
 
-        return result;
+    std::function<BigInt()> mod_exp_work(const BigInt &exp, const BigInt &mod) const
+    {
+        return [base = *this, exp = exp, mod = mod]()
+        {
+            return BigInt_mod_exp(base, exp, mod);
+        };
     }
 
-    static std::vector<unsigned long long> newton_inverse(std::vector<unsigned long long> f, int l)
+    // Первые два разряда a, выровненные по длине len
+    static unsigned long long leading_limbs(const std::vector<unsigned long long> &a, size_t len)
     {
-        unsigned int k = std::ceil(std::log2(l))/*  + 1 */;
-        std::vector<unsigned long long> g{mod_inv(f[0])};
-        BigInt gi(g), fi(f);
-        for (size_t i = 1; i <= k; i++)
+        size_t shift = len - a.size();
+        unsigned long long hi = shift == 0 ? a[0] : 0;
+        unsigned long long lo = shift == 0 ? a[1] : (shift == 1 ? a[0] : 0);
+        return hi * DEFAULT_MODULE + lo;
+    }
+
+    // r = A * a + B * b при условии, что результат неотрицателен
+    static std::vector<unsigned long long> linear_combination(long long A, const std::vector<unsigned long long> &a, long long B, const std::vector<unsigned long long> &b)
+    {
+        std::vector<unsigned long long> result(std::max(a.size(), b.size()) + 1);
+        int128 carry = 0;
+        for (size_t k = 0; k < result.size(); k++)
         {
-            gi = (BigInt(2) * gi - fi * gi.mod_exp(BigInt(2)));
-            if(gi.digits.size() > (size_t)(1 << i)){
-                gi.digits = {gi.digits.begin() + gi.digits.size() - (1 << i), gi.digits.end()};
+            int128 cur = carry;
+            if (k < a.size())
+            {
+                cur += (int128)A * (int128)a[a.size() - 1 - k];
+            }
+            if (k < b.size())
+            {
+                cur += (int128)B * (int128)b[b.size() - 1 - k];
+            }
+            int128 mod = cur % (int128)DEFAULT_MODULE;
+            if (mod < 0)
+            {
+                mod += DEFAULT_MODULE;
             }
-            
+            carry = (cur - mod) / (int128)DEFAULT_MODULE;
+            result[result.size() - 1 - k] = (unsigned long long)mod;
         }
+        trim_magnitude(result);
+        return result;
+    }
 
-        return gi.digits;
+    static bool is_zero_magnitude(const std::vector<unsigned long long> &a)
+    {
+        return a.size() == 1 && a[0] == 0;
     }
 
-    static unsigned long long mod_inv(unsigned long long a, unsigned long long module = 1000000000)
+    // Один шаг Евклида делением: (a, b) -> (b, a mod b)
+    static void gcd_division_step(std::vector<unsigned long long> &a, std::vector<unsigned long long> &b, GcdMatrix *m)
     {
-        if (a == 0)
+        std::vector<unsigned long long> r;
+        std::vector<unsigned long long> q = divmod_magnitude(a, b, r);
+        if (m)
         {
-            throw std::exception();
+            m->left_multiply(BigInt(0), BigInt(1), BigInt(1), from_magnitude(q, true));
         }
-        else if (a % 2 == 0 || a % 5 == 0)
+        a.swap(b);
+        b.swap(r);
+    }
+
+    // Шаг Лемера (Кнут, алгоритм L) по двум старшим разрядам, false если ни одного частного угадать не удалось
+    static bool gcd_lehmer_step(std::vector<unsigned long long> &a, std::vector<unsigned long long> &b, GcdMatrix *m)
+    {
+        const size_t len = a.size();
+        if (len < 2 || len - b.size() > 1)
         {
-            a++;
+            return false;
         }
-
-        // Используем расширенный алгоритм Евклида
-        long long m = module;
-        long long y = 0, x = 1;
-        long long original_m = m;
-
-        if (m == 1)
+        long long ahat = leading_limbs(a, len), bhat = leading_limbs(b, len);
+        long long A = 1, B = 0, C = 0, D = 1;
+        while (bhat + C != 0 && bhat + D != 0)
         {
-            return 0;
+            long long q = (ahat + A) / (bhat + C);
+            if (q != (ahat + B) / (bhat + D))
+            {
+                break;
+            }
+            long long t = A - q * C;
+            A = C;
+            C = t;
+            t = B - q * D;
+            B = D;
+            D = t;
+            t = ahat - q * bhat;
+            ahat = bhat;
+            bhat = t;
         }
-
-        while (a > 1)
+        if (B == 0)
         {
-            long long q = a / m;
-            long long t = m;
+            return false;
+        }
+        std::vector<unsigned long long> new_a = linear_combination(A, a, B, b);
+        std::vector<unsigned long long> new_b = linear_combination(C, a, D, b);
+        a.swap(new_a);
+        b.swap(new_b);
+        if (m)
+        {
+            m->left_multiply(BigInt(A), BigInt(B), BigInt(C), BigInt(D));
+        }
+        return true;
+    }
 
-            m = a % m;
-            a = t;
-            t = y;
+    // Рекурсивный шаг (half-GCD): матрица частных считается по старшим разрядам
+    // и применяется к полным числам. Возвращает false, если она не уменьшила числа.
+    static bool gcd_half_step(std::vector<unsigned long long> &a, std::vector<unsigned long long> &b, size_t stop, GcdMatrix *m)
+    {
+        const size_t len = a.size();
+        // Старшие 2 * need разрядов сокращаются примерно вдвое; если нужно сократить больше
+        // четверти длины, сначала рекурсивно обрабатывается старшая половина
+        const size_t need = len - stop;
+        const size_t low = (4 * need <= len) ? len - 2 * need : len / 2;
 
-            y = x - q * y;
-            x = t;
+        std::vector<unsigned long long> a_hi(a.begin(), a.end() - low);
+        std::vector<unsigned long long> b_hi;
+        if (b.size() > low)
+        {
+            b_hi.assign(b.begin(), b.end() - low);
         }
+        trim_magnitude(b_hi);
 
-        if (x < 0)
+        GcdMatrix step;
+        gcd_reduce(a_hi, b_hi, &step, (len - low) / 2 + 1);
+
+        const BigInt full_a = from_magnitude(a, false), full_b = from_magnitude(b, false);
+        BigInt new_a = step.at(0, 0).karatsuba_multiply(full_a) + step.at(0, 1).karatsuba_multiply(full_b);
+        BigInt new_b = step.at(1, 0).karatsuba_multiply(full_a) + step.at(1, 1).karatsuba_multiply(full_b);
+        // На старших разрядах последние частные могли оказаться неверными: чиним знаки и порядок,
+        // унимодулярность матрицы при этом сохраняется
+        for (int row = 0; row < 2; row++)
         {
-            x += original_m;
+            BigInt &value = row == 0 ? new_a : new_b;
+            if (value.isNegative)
+            {
+                value.isNegative = false;
+                step.at(row, 0) = BigInt(0) - step.at(row, 0);
+                step.at(row, 1) = BigInt(0) - step.at(row, 1);
+            }
+        }
+        trim_magnitude(limbs_for_write(new_a.digits));
+        trim_magnitude(limbs_for_write(new_b.digits));
+        if (compare_magnitude(new_a.digits, new_b.digits) < 0)
+        {
+            BigInt::swap(new_a, new_b);
+            std::swap(step.at(0, 0), step.at(1, 0));
+            std::swap(step.at(0, 1), step.at(1, 1));
+        }
+        if (new_a.digits.size() >= len)
+        {
+            return false;
         }
 
-        return x;
+        a.swap(limbs_for_write(new_a.digits));
+        b.swap(limbs_for_write(new_b.digits));
+        if (m)
+        {
+            m->left_multiply(step.at(0, 0), step.at(0, 1), step.at(1, 0), step.at(1, 1));
+        }
+        return true;
     }
 
-    /* static unsigned long long mod_inv(unsigned long long a, unsigned int MOD)
+    // Шаги Евклида над a >= b, пока b не станет короче stop разрядов (stop == 0 - до нуля)
+    static void gcd_reduce(std::vector<unsigned long long> &a, std::vector<unsigned long long> &b, GcdMatrix *m, size_t stop = 0)
     {
-        unsigned long long res = 1;
-        unsigned long long p = MOD - 2;
-        while (p)
+        while (!is_zero_magnitude(b) && b.size() > stop)
         {
-            if (p & 1)
-                res = (res * a) % MOD;
-            a = (a * a) % MOD;
-            p >>= 1;
+            if (!m && a.size() <= 2)
+            {
+                unsigned long long x = leading_limbs(a, 2), y = leading_limbs(b, 2);
+                while (y != 0)
+                {
+                    unsigned long long t = x % y;
+                    x = y;
+                    y = t;
+                }
+                a = {x / DEFAULT_MODULE, x % DEFAULT_MODULE};
+                trim_magnitude(a);
+                b = {0};
+                return;
+            }
+            if (a.size() >= HGCD_THRESHOLD && a.size() - b.size() <= 1 && gcd_half_step(a, b, stop, m))
+            {
+                continue;
+            }
+            if (!gcd_lehmer_step(a, b, m))
+            {
+                gcd_division_step(a, b, m);
+            }
         }
-        return res;
-    } */
+    }
 
-private:
     BigInt(std::vector<unsigned long long> vec)
     {
         bool notnull = false;
@@ -979,32 +4224,6 @@ private:
         isNegative = _isNegative;
     }
 
-    static void fft(std::vector<std::complex<long double>> &a, const std::complex<long double> w)
-    {
-        int n = (int)a.size();
-        if (n == 1)
-        {
-            return;
-        }
-        std::vector<std::complex<long double>> a0(n / 2), a1(n / 2);
-        std::complex<long double> wn(1, 0);
-        for (int i = n / 2 - 1; i >= 0; --i)
-        {
-            a0[i] = a[i + n / 2] + a[i];
-            a1[i] = (a[i + n / 2] - a[i]) * wn;
-            wn *= w;
-        }
-        fft(a0, w * w);
-        fft(a1, w * w);
-
-        for (int i = n / 2 - 1; i >= 0; --i)
-        {
-            a[2 * i] = a1[i];
-            a[2 * i + 1] = a0[i];
-        }
-
-    }
-
     static void normalize(std::vector<unsigned long long> &_digits, unsigned long long _module = 1000000000)
     {
         std::vector<unsigned long long> _digits_new;
@@ -1030,38 +4249,15 @@ private:
         std::reverse(_res_digits.begin(), _res_digits.end());
     }
 
-    static void take_dozen_for(std::vector<unsigned long long> &_digits, const size_t &index, unsigned long long _module = 1000000000)
-    {
-        if (index == 0)
-        {
-            return;
-        }
-        int take = index - 1;
-        for (int i = index - 1; i >= 0 && _digits[i] == 0; i--)
-        {
-            _digits[i] = _module - 1;
-            take--;
-        }
-        --_digits[take];
-    }
-
-    static void take_zeroes_from_end_ans_reverse(std::vector<unsigned long long> &_digits)
-    {
-        int index = _digits.size() - 1;
-        while (index > 0 && _digits[index--] == 0)
-        {
-            _digits.pop_back();
-        }
-        std::reverse(_digits.begin(), _digits.end());
-    }
-
     static std::string to_string(const BigInt &element)
     {
-        std::string bigIntNumber_str = std::to_string(element.digits[0]);
+        // У BigInt() разрядов нет вовсе, magnitude() отдаёт для него {0}
+        const std::vector<unsigned long long> &limbs = element.magnitude();
+        std::string bigIntNumber_str = std::to_string(limbs[0]);
 
-        for (size_t i = 1; i < element.digits.size(); i++)
+        for (size_t i = 1; i < limbs.size(); i++)
         {
-            if (element.digits[i] == 0)
+            if (limbs[i] == 0)
             {
                 for (unsigned long long j = 1; j < element.module; j *= 10)
                 {
@@ -1071,19 +4267,30 @@ private:
             }
             else
             {
-                int j = NUMBER_LENGTH(element.digits[i]);
+                int j = NUMBER_LENGTH(limbs[i]);
                 int mod_length = NUMBER_LENGTH(element.module) - 1;
                 while (j++ < mod_length)
                 {
                     bigIntNumber_str += '0';
                 }
-                bigIntNumber_str += std::to_string(element.digits[i]);
+                bigIntNumber_str += std::to_string(limbs[i]);
             }
         }
         return bigIntNumber_str;
     }
 
-    std::vector<unsigned long long> digits;
+    LimbBuffer digits;
     bool isNegative;
     /*  const  */unsigned long long module = 1000000000;//1000000000; // 1000000000;
-};
\ No newline at end of file
+};
+
+using BigIntAccumulator = BigInt::Accumulator;
+
+template <>
+struct std::hash<BigInt>
+{
+    size_t operator()(const BigInt &value) const noexcept
+    {
+        return value.hash();
+    }
+};
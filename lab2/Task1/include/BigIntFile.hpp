@@ -0,0 +1,253 @@
+#pragma once
+#include "BigInt.hpp"
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Файловый формат с сырыми разрядами: заголовок BigIntFile::Header (32 байта), затем
+// limb_count разрядов по 8 байт в порядке little-endian, старший разряд первым - ровно как
+// в BigInt::digits. Сохранение и загрузка сводятся к одному копированию без перевода в десятичную систему
+class BigIntFile
+{
+public:
+    static constexpr std::array<char, 8> MAGIC = {'B', 'I', 'G', 'I', 'N', 'T', '\0', '\0'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t FLAG_NEGATIVE = 1;
+
+    struct Header
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t flags;
+        uint64_t limb_base;
+        uint64_t limb_count;
+    };
+    static_assert(sizeof(Header) == 32, "заголовок должен выравнивать разряды по 8 байт");
+
+    static void save(const std::string &path, const BigInt &value)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            throw std::exception();
+        }
+        write(out, value);
+    }
+
+    static BigInt load(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            throw std::exception();
+        }
+        return read(in);
+    }
+
+    static void write(std::ostream &out, const BigInt &value)
+    {
+        const std::vector<unsigned long long> &limbs = value.magnitude();
+        Header header = make_header(value.is_negative(), limbs.size());
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        if constexpr (std::endian::native == std::endian::little)
+        {
+            out.write(reinterpret_cast<const char *>(limbs.data()), (std::streamsize)(limbs.size() * sizeof(uint64_t)));
+        }
+        else
+        {
+            for (unsigned long long limb : limbs)
+            {
+                uint64_t stored = std::byteswap((uint64_t)limb);
+                out.write(reinterpret_cast<const char *>(&stored), sizeof(stored));
+            }
+        }
+        if (!out)
+        {
+            throw std::exception();
+        }
+    }
+
+    static BigInt read(std::istream &in)
+    {
+        Header header;
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            throw std::exception();
+        }
+        header = from_stored(header);
+        check_header(header);
+
+        std::vector<unsigned long long> limbs(header.limb_count);
+        if (!in.read(reinterpret_cast<char *>(limbs.data()), (std::streamsize)(limbs.size() * sizeof(uint64_t))))
+        {
+            throw std::exception();
+        }
+        if constexpr (std::endian::native != std::endian::little)
+        {
+            for (unsigned long long &limb : limbs)
+            {
+                limb = std::byteswap((uint64_t)limb);
+            }
+        }
+        return make_bigint(std::span<const unsigned long long>(limbs), (header.flags & FLAG_NEGATIVE) != 0);
+    }
+
+private:
+    friend class MappedBigInt;
+    friend class OutOfCoreMultiplier;
+
+    static Header make_header(bool negative, size_t limb_count)
+    {
+        Header header{MAGIC, VERSION, negative ? FLAG_NEGATIVE : 0, BigInt::DEFAULT_MODULE, limb_count};
+        return from_stored(header);
+    }
+
+    // Поля заголовка хранятся в little-endian; преобразование симметрично
+    static Header from_stored(Header header)
+    {
+        if constexpr (std::endian::native != std::endian::little)
+        {
+            header.version = std::byteswap(header.version);
+            header.flags = std::byteswap(header.flags);
+            header.limb_base = std::byteswap(header.limb_base);
+            header.limb_count = std::byteswap(header.limb_count);
+        }
+        return header;
+    }
+
+    static void check_header(const Header &header)
+    {
+        if (header.magic != MAGIC || header.version != VERSION || header.limb_base != BigInt::DEFAULT_MODULE ||
+            header.limb_count == 0 || (header.flags & ~FLAG_NEGATIVE) != 0)
+        {
+            throw std::exception();
+        }
+    }
+
+    // Разряды из файла проверяются: каждый меньше основания, старший ненулевой
+    static BigInt make_bigint(std::span<const unsigned long long> limbs, bool negative)
+    {
+        for (unsigned long long limb : limbs)
+        {
+            if (limb >= BigInt::DEFAULT_MODULE)
+            {
+                throw std::exception();
+            }
+        }
+        if (limbs.size() > 1 && limbs.front() == 0)
+        {
+            throw std::exception();
+        }
+        return BigInt::from_magnitude(std::vector<unsigned long long>(limbs.begin(), limbs.end()), negative);
+    }
+};
+
+// Файл формата BigIntFile, отображённый в память через mmap: разряды доступны сразу,
+// без чтения и разбора; копия в BigInt делается только по запросу
+class MappedBigInt
+{
+public:
+    explicit MappedBigInt(const std::string &path)
+    {
+        static_assert(std::endian::native == std::endian::little, "отображение без копирования требует little-endian");
+
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw std::exception();
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BigIntFile::Header))
+        {
+            ::close(fd);
+            throw std::exception();
+        }
+        _size = (size_t)st.st_size;
+        void *address = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (address == MAP_FAILED)
+        {
+            throw std::exception();
+        }
+        _address = address;
+        ::madvise(_address, _size, MADV_SEQUENTIAL);
+
+        std::memcpy(&_header, _address, sizeof(_header));
+        try
+        {
+            BigIntFile::check_header(_header);
+            if (_header.limb_count > (_size - sizeof(_header)) / sizeof(uint64_t))
+            {
+                throw std::exception();
+            }
+        }
+        catch (...)
+        {
+            unmap();
+            throw;
+        }
+    }
+
+    MappedBigInt(const MappedBigInt &) = delete;
+    MappedBigInt &operator=(const MappedBigInt &) = delete;
+
+    MappedBigInt(MappedBigInt &&other) noexcept
+        : _address(std::exchange(other._address, nullptr)), _size(std::exchange(other._size, 0)), _header(other._header)
+    {
+    }
+
+    MappedBigInt &operator=(MappedBigInt &&other) noexcept
+    {
+        if (this != &other)
+        {
+            unmap();
+            _address = std::exchange(other._address, nullptr);
+            _size = std::exchange(other._size, 0);
+            _header = other._header;
+        }
+        return *this;
+    }
+
+    ~MappedBigInt()
+    {
+        unmap();
+    }
+
+    // Разряды по основанию 10^9, старший первым - тот же порядок, что и в BigInt
+    std::span<const unsigned long long> limbs() const
+    {
+        const char *begin = static_cast<const char *>(_address) + sizeof(BigIntFile::Header);
+        return {reinterpret_cast<const unsigned long long *>(begin), (size_t)_header.limb_count};
+    }
+
+    bool is_negative() const
+    {
+        return (_header.flags & BigIntFile::FLAG_NEGATIVE) != 0;
+    }
+
+    BigInt to_bigint() const
+    {
+        return BigIntFile::make_bigint(limbs(), is_negative());
+    }
+
+private:
+    void unmap()
+    {
+        if (_address != nullptr)
+        {
+            ::munmap(_address, _size);
+            _address = nullptr;
+        }
+    }
+
+    void *_address = nullptr;
+    size_t _size = 0;
+    BigIntFile::Header _header{};
+};
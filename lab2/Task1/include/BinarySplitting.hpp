@@ -0,0 +1,114 @@
+#pragma once
+#include "BigInt.hpp"
+#include <future>
+#include <utility>
+
+// Вычисление гипергеометрических рядов методом двоичного разбиения:
+// S = sum_{k = 0}^{n - 1} a(k) * p(0) * ... * p(k) / (q(0) * ... * q(k)) = T / Q
+template <typename PTerm, typename QTerm, typename ATerm>
+class BinarySplitting
+{
+public:
+    struct Node
+    {
+        BigInt P, Q, T;
+    };
+
+    // parallel_depth - сколько верхних уровней рекурсии считать параллельно (0 - последовательно).
+    // Генераторы p, q, a при parallel_depth > 0 должны быть потокобезопасными.
+    BinarySplitting(PTerm p, QTerm q, ATerm a, unsigned parallel_depth = 0)
+        : _p(std::move(p)), _q(std::move(q)), _a(std::move(a)), _parallel_depth(parallel_depth)
+    {
+    }
+
+    // Возвращает пару {T, Q}: числитель и знаменатель частичной суммы из n членов
+    std::pair<BigInt, BigInt> evaluate(unsigned long long n) const
+    {
+        if (n == 0)
+        {
+            return {BigInt(0), BigInt(1)};
+        }
+        Node result;
+        split(0, n, result, 0, false);
+        return {std::move(result.T), std::move(result.Q)};
+    }
+
+    // Узел [begin, end) целиком, включая произведение P
+    Node evaluate_node(unsigned long long begin, unsigned long long end) const
+    {
+        if (begin >= end)
+        {
+            throw std::exception();
+        }
+        Node result;
+        split(begin, end, result, 0, true);
+        return result;
+    }
+
+private:
+    // need_P == false у правой границы всего диапазона: P там уже никому не нужно
+    void split(unsigned long long begin, unsigned long long end, Node &out, unsigned depth, bool need_P) const
+    {
+        if (end - begin == 1)
+        {
+            out.P = BigInt(_p(begin));
+            out.Q = BigInt(_q(begin));
+            out.T = BigInt(_a(begin)) * out.P;
+            return;
+        }
+        if (end - begin == 2)
+        {
+            BigInt p1 = _p(begin + 1);
+            out.P = BigInt(_p(begin));
+            out.Q = BigInt(_q(begin));
+            BigInt q1 = _q(begin + 1);
+            out.T = BigInt(_a(begin)) * out.P * q1 + BigInt(_a(begin + 1)) * out.P * p1;
+            out.Q *= q1;
+            if (need_P)
+            {
+                out.P *= p1;
+            }
+            return;
+        }
+
+        const unsigned long long mid = begin + (end - begin) / 2;
+        Node right;
+        if (depth < _parallel_depth)
+        {
+            auto future = std::async(std::launch::async, [this, mid, end, &right, depth, need_P]()
+                                     { split(mid, end, right, depth + 1, need_P); });
+            split(begin, mid, out, depth + 1, true);
+            future.get();
+        }
+        else
+        {
+            split(begin, mid, out, depth + 1, true);
+            split(mid, end, right, depth + 1, need_P);
+        }
+        merge(out, std::move(right), need_P);
+    }
+
+    // Склеивание соседних узлов прямо в левом, правый узел отдаёт свою память
+    static void merge(Node &left, Node &&right, bool need_P)
+    {
+        left.T *= right.Q;
+        right.T *= left.P;
+        left.T += right.T;
+        left.Q *= right.Q;
+        if (need_P)
+        {
+            left.P *= right.P;
+        }
+    }
+
+    PTerm _p;
+    QTerm _q;
+    ATerm _a;
+    unsigned _parallel_depth;
+};
+
+template <typename PTerm, typename QTerm, typename ATerm>
+std::pair<BigInt, BigInt> binary_splitting(PTerm p, QTerm q, ATerm a, unsigned long long n, unsigned parallel_depth = 0)
+{
+    return BinarySplitting<PTerm, QTerm, ATerm>(std::move(p), std::move(q), std::move(a), parallel_depth).evaluate(n);
+}
@@ -0,0 +1,360 @@
+#pragma once
+#include "BigInt.hpp"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+// Возведение фиксированного основания g в разные степени по фиксированному модулю m.
+// Показатель режется на окна по w бит; для окна k заранее хранятся g^(j * 2^(w k)), 0 < j < 2^w,
+// поэтому g^e - произведение не более ceil(bits / w) значений из таблицы без возведений в квадрат.
+// Для модулей, взаимно простых с module, таблица хранится в форме Монтгомери, иначе - обычными
+// вычетами с делением по Барретту. Таблицу можно сохранить в файл и загрузить без пересчёта
+class FixedBaseExponentiator
+{
+public:
+    static constexpr std::array<char, 8> MAGIC = {'B', 'I', 'G', 'F', 'B', 'E', 'X', 'P'};
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t FLAG_MONTGOMERY = 1;
+    static constexpr unsigned MAX_WINDOW = 16;
+
+    struct Header
+    {
+        std::array<char, 8> magic;
+        uint32_t version;
+        uint32_t flags;
+        uint32_t window;
+        uint32_t reserved;
+        uint64_t max_bits;
+        uint64_t limb_count;
+    };
+    static_assert(sizeof(Header) == 40, "заголовок должен выравнивать разряды по 8 байт");
+
+    // max_bits - наибольшая длина показателя, покрытая таблицей (по умолчанию - длина модуля);
+    // window - ширина окна в битах (0 - выбрать по max_bits)
+    FixedBaseExponentiator(const BigInt &base, const BigInt &modulus, size_t max_bits = 0, unsigned window = 0)
+    {
+        init_modulus(modulus);
+        _max_bits = max_bits != 0 ? max_bits : bit_length(modulus.magnitude());
+        _window = window != 0 ? window : (_max_bits <= 128 ? 4 : (_max_bits <= 1024 ? 5 : 6));
+        if (_window > MAX_WINDOW)
+        {
+            throw std::exception();
+        }
+        _base = reduce(base);
+
+        const size_t windows = (_max_bits + _window - 1) / _window, per_window = (size_t(1) << _window) - 1;
+        _table.reserve(windows * per_window);
+        Residue power = to_residue(_base); // g^(2^(w k))
+        for (size_t k = 0; k < windows; k++)
+        {
+            _table.push_back(power);
+            for (size_t j = 1; j < per_window; j++)
+            {
+                _table.push_back(multiply(_table.back(), power));
+            }
+            power = multiply(_table.back(), power);
+        }
+    }
+
+    const BigInt &base() const
+    {
+        return _base;
+    }
+
+    const BigInt &modulus() const
+    {
+        return _modulus;
+    }
+
+    size_t max_bits() const
+    {
+        return _max_bits;
+    }
+
+    unsigned window() const
+    {
+        return _window;
+    }
+
+    // g^exp mod m; показатели длиннее max_bits считаются обычным двоичным возведением
+    BigInt pow(const BigInt &exp) const
+    {
+        if (exp.is_negative())
+        {
+            throw std::exception();
+        }
+        std::vector<uint32_t> words = BigInt::to_binary_words(exp.magnitude());
+        const size_t bits = bit_length(words);
+        if (bits > _max_bits)
+        {
+            // Показатель длиннее таблицы: обычное возведение, но в тех же вычетах
+            Residue result = to_residue(reduce(BigInt(1)));
+            for (size_t i = bits; i-- > 0;)
+            {
+                result = multiply(result, result);
+                if ((words[i / 32] >> (i % 32)) & 1)
+                {
+                    result = multiply(result, _table.front());
+                }
+            }
+            return from_residue(result);
+        }
+
+        auto window_value = [&words, this](size_t k)
+        {
+            size_t value = 0;
+            for (size_t i = k * _window + _window; i-- > k * _window;)
+            {
+                value = (value << 1) | (i / 32 < words.size() ? (words[i / 32] >> (i % 32)) & 1 : 0);
+            }
+            return value;
+        };
+
+        const size_t per_window = (size_t(1) << _window) - 1;
+        std::optional<Residue> result;
+        for (size_t k = 0; k * _window < bits; k++)
+        {
+            const size_t value = window_value(k);
+            if (value != 0)
+            {
+                const Residue &entry = _table[k * per_window + value - 1];
+                result = result ? multiply(*result, entry) : entry;
+            }
+        }
+        if (!result)
+        {
+            return reduce(BigInt(1));
+        }
+        return from_residue(*result);
+    }
+
+    void save(const std::string &path) const
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+        {
+            throw std::exception();
+        }
+        write(out);
+    }
+
+    static FixedBaseExponentiator load(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+        {
+            throw std::exception();
+        }
+        return read(in);
+    }
+
+    // Заголовок, модуль и основание (по limb_count разрядов, старший первым), затем таблица
+    // по окнам; все поля и разряды - little-endian, как в BigIntFile
+    void write(std::ostream &out) const
+    {
+        Header header{MAGIC, VERSION, _ctx ? FLAG_MONTGOMERY : 0, _window, 0, _max_bits, _limbs};
+        header = from_stored(header);
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        write_limbs(out, padded(_modulus.magnitude()));
+        write_limbs(out, padded(_base.magnitude()));
+        for (const Residue &entry : _table)
+        {
+            write_limbs(out, entry);
+        }
+        if (!out)
+        {
+            throw std::exception();
+        }
+    }
+
+    static FixedBaseExponentiator read(std::istream &in)
+    {
+        Header header;
+        if (!in.read(reinterpret_cast<char *>(&header), sizeof(header)))
+        {
+            throw std::exception();
+        }
+        header = from_stored(header);
+        if (header.magic != MAGIC || header.version != VERSION || (header.flags & ~FLAG_MONTGOMERY) != 0 ||
+            header.window == 0 || header.window > MAX_WINDOW || header.max_bits == 0 || header.limb_count == 0)
+        {
+            throw std::exception();
+        }
+
+        FixedBaseExponentiator result;
+        std::vector<unsigned long long> modulus = read_limbs(in, header.limb_count), base = read_limbs(in, header.limb_count);
+        BigInt::trim_magnitude(modulus);
+        BigInt::trim_magnitude(base);
+        result.init_modulus(BigInt::from_magnitude(std::move(modulus), false));
+        if (result._limbs != header.limb_count || result._ctx.has_value() != ((header.flags & FLAG_MONTGOMERY) != 0) ||
+            BigInt::compare_magnitude(base, result._modulus.magnitude()) >= 0)
+        {
+            throw std::exception();
+        }
+        result._base = BigInt::from_magnitude(std::move(base), false);
+        result._max_bits = header.max_bits;
+        result._window = header.window;
+
+        const size_t windows = (result._max_bits + result._window - 1) / result._window, per_window = (size_t(1) << result._window) - 1;
+        for (size_t i = 0; i < windows * per_window; i++)
+        {
+            result._table.push_back(read_limbs(in, result._limbs));
+        }
+        // Первая запись - само основание: дешёвая проверка, что таблица от этого модуля и основания
+        if (result._table.front() != result.to_residue(result._base))
+        {
+            throw std::exception();
+        }
+        return result;
+    }
+
+private:
+    // Вычет: ровно _limbs разрядов, младший первым
+    using Residue = std::vector<unsigned long long>;
+
+    FixedBaseExponentiator() = default;
+
+    void init_modulus(const BigInt &modulus)
+    {
+        if (modulus.is_negative() || BigInt::compare_magnitude(modulus.magnitude(), {1}) <= 0)
+        {
+            throw std::exception();
+        }
+        _modulus = BigInt::from_magnitude(modulus.magnitude(), false);
+        _limbs = _modulus.magnitude().size();
+        if (BigInt::MontgomeryContext::is_suitable(_modulus))
+        {
+            _ctx.emplace(_modulus);
+        }
+        else
+        {
+            _barrett = BigInt::barrett_inverse(_modulus.magnitude());
+        }
+    }
+
+    // x mod m в [0, m)
+    BigInt reduce(const BigInt &x) const
+    {
+        std::vector<unsigned long long> rem;
+        BigInt::divmod_magnitude(x.magnitude(), _modulus.magnitude(), rem);
+        if (x.is_negative() && !BigInt::is_zero_magnitude(rem))
+        {
+            rem = BigInt::sub_magnitude(_modulus.magnitude(), rem);
+        }
+        return BigInt::from_magnitude(std::move(rem), false);
+    }
+
+    Residue to_residue(const BigInt &x) const
+    {
+        if (_ctx)
+        {
+            return _ctx->to_montgomery(x);
+        }
+        const std::vector<unsigned long long> padded_value = padded(x.magnitude());
+        return Residue(padded_value.rbegin(), padded_value.rend());
+    }
+
+    BigInt from_residue(const Residue &x) const
+    {
+        if (_ctx)
+        {
+            return _ctx->from_montgomery(x);
+        }
+        std::vector<unsigned long long> value(x.rbegin(), x.rend());
+        BigInt::trim_magnitude(value);
+        return BigInt::from_magnitude(std::move(value), false);
+    }
+
+    Residue multiply(const Residue &a, const Residue &b) const
+    {
+        if (_ctx)
+        {
+            return _ctx->multiply(a, b);
+        }
+        std::vector<unsigned long long> x(a.rbegin(), a.rend()), y(b.rbegin(), b.rend()), rem;
+        BigInt::trim_magnitude(x);
+        BigInt::trim_magnitude(y);
+        BigInt::barrett_divmod(BigInt::fast_mul_magnitude(x, y), _modulus.magnitude(), _barrett, rem);
+        std::vector<unsigned long long> padded_rem = padded(rem);
+        return Residue(padded_rem.rbegin(), padded_rem.rend());
+    }
+
+    // Разряды старшим первым, дополненные нулями слева до _limbs
+    std::vector<unsigned long long> padded(const std::vector<unsigned long long> &mag) const
+    {
+        std::vector<unsigned long long> result(_limbs - std::min(_limbs, mag.size()), 0);
+        result.insert(result.end(), mag.begin(), mag.end());
+        return result;
+    }
+
+    static size_t bit_length(const std::vector<uint32_t> &words)
+    {
+        for (size_t i = words.size(); i-- > 0;)
+        {
+            if (words[i] != 0)
+            {
+                return i * 32 + (size_t)std::bit_width(words[i]);
+            }
+        }
+        return 0;
+    }
+
+    static size_t bit_length(const std::vector<unsigned long long> &mag)
+    {
+        return bit_length(BigInt::to_binary_words(mag));
+    }
+
+    static Header from_stored(Header header)
+    {
+        if constexpr (std::endian::native != std::endian::little)
+        {
+            header.version = std::byteswap(header.version);
+            header.flags = std::byteswap(header.flags);
+            header.window = std::byteswap(header.window);
+            header.max_bits = std::byteswap(header.max_bits);
+            header.limb_count = std::byteswap(header.limb_count);
+        }
+        return header;
+    }
+
+    static void write_limbs(std::ostream &out, const std::vector<unsigned long long> &limbs)
+    {
+        for (unsigned long long limb : limbs)
+        {
+            uint64_t stored = std::endian::native == std::endian::little ? (uint64_t)limb : std::byteswap((uint64_t)limb);
+            out.write(reinterpret_cast<const char *>(&stored), sizeof(stored));
+        }
+    }
+
+    static std::vector<unsigned long long> read_limbs(std::istream &in, size_t count)
+    {
+        std::vector<unsigned long long> limbs(count);
+        if (!in.read(reinterpret_cast<char *>(limbs.data()), (std::streamsize)(count * sizeof(uint64_t))))
+        {
+            throw std::exception();
+        }
+        for (unsigned long long &limb : limbs)
+        {
+            if constexpr (std::endian::native != std::endian::little)
+            {
+                limb = std::byteswap((uint64_t)limb);
+            }
+            if (limb >= BigInt::DEFAULT_MODULE)
+            {
+                throw std::exception();
+            }
+        }
+        return limbs;
+    }
+
+    BigInt _modulus, _base;
+    std::optional<BigInt::MontgomeryContext> _ctx;
+    std::vector<unsigned long long> _barrett;
+    size_t _limbs = 0, _max_bits = 0;
+    unsigned _window = 0;
+    std::vector<Residue> _table;
+};
@@ -0,0 +1,859 @@
+#pragma once
+#include "BigInt.hpp"
+#include <array>
+#include <bit>
+#include <compare>
+#include <concepts>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Беззнаковое число фиксированной разрядности Bits с арифметикой по модулю 2^Bits.
+// Разряды - 64-битные слова прямо в объекте (младшее первым), куча не используется.
+// Сложение, вычитание, умножение и сравнение до UNROLL_LIMBS разрядов разворачиваются на этапе компиляции,
+// на больших ширинах - обычные циклы.
+template <size_t Bits>
+struct FixedMontgomeryParams;
+
+template <size_t Bits>
+class FixedBigInt
+{
+    static_assert(Bits > 0 && Bits % 64 == 0, "Bits must be a positive multiple of 64");
+
+    template <size_t>
+    friend class FixedBigInt;
+
+    template <size_t>
+    friend struct FixedMontgomeryParams;
+
+public:
+    static constexpr size_t LIMBS = Bits / 64;
+    // Выше этой ширины развёрнутое умножение (LIMBS^2 / 2 шагов) только раздувает время компиляции и код
+    static constexpr size_t UNROLL_LIMBS = 8;
+    using Limbs = std::array<uint64_t, LIMBS>;
+
+    constexpr FixedBigInt() : limbs{} {}
+
+    // Отрицательные значения записываются в дополнительном коде
+    template <std::integral T>
+    constexpr FixedBigInt(T value) : limbs{}
+    {
+        limbs[0] = (uint64_t)value;
+        if constexpr (std::is_signed_v<T>)
+        {
+            if (value < 0)
+            {
+                for (size_t i = 1; i < LIMBS; i++)
+                {
+                    limbs[i] = ~0ULL;
+                }
+            }
+        }
+    }
+
+    constexpr explicit FixedBigInt(const std::string &str) : limbs{}
+    {
+        size_t i = 0;
+        bool negative = false;
+        if (!str.empty() && str[0] == '-')
+        {
+            negative = true;
+            ++i;
+        }
+        if (i == str.size())
+        {
+            throw std::exception();
+        }
+        while (i < str.size())
+        {
+            uint64_t chunk = 0, scale = 1;
+            for (size_t end = std::min(str.size(), i + 19); i < end; i++)
+            {
+                if (str[i] < '0' || str[i] > '9')
+                {
+                    throw std::exception();
+                }
+                chunk = chunk * 10 + (str[i] - '0');
+                scale *= 10;
+            }
+            mul_add_1(limbs, scale, chunk);
+        }
+        if (negative)
+        {
+            *this = -*this;
+        }
+    }
+
+    // Значение берётся по модулю 2^Bits (отрицательные - в дополнительном коде)
+    explicit FixedBigInt(const BigInt &value) : limbs{}
+    {
+        for (size_t i = 0; i < value.digits.size(); i++)
+        {
+            mul_add_1(limbs, BigInt::DEFAULT_MODULE, value.digits[i]);
+        }
+        if (value.isNegative)
+        {
+            *this = -*this;
+        }
+    }
+
+    // Расширение неявное, сужение (с отбрасыванием старших разрядов) - только явное
+    template <size_t OtherBits>
+    constexpr explicit(OtherBits > Bits) FixedBigInt(const FixedBigInt<OtherBits> &other) : limbs{}
+    {
+        for (size_t i = 0; i < std::min(LIMBS, FixedBigInt<OtherBits>::LIMBS); i++)
+        {
+            limbs[i] = other.limbs[i];
+        }
+    }
+
+    BigInt to_bigint() const
+    {
+        std::vector<unsigned long long> digits;
+        Limbs rest = limbs;
+        while (!is_zero_limbs(rest))
+        {
+            digits.push_back(divrem_1(rest, BigInt::DEFAULT_MODULE));
+        }
+        std::reverse(digits.begin(), digits.end());
+        return BigInt::from_magnitude(std::move(digits), false);
+    }
+
+    operator BigInt() const
+    {
+        return to_bigint();
+    }
+
+    constexpr FixedBigInt operator+(const FixedBigInt &other) const
+    {
+        FixedBigInt result;
+        add_limbs(result.limbs, limbs, other.limbs);
+        return result;
+    }
+
+    constexpr FixedBigInt operator-(const FixedBigInt &other) const
+    {
+        FixedBigInt result;
+        sub_limbs(result.limbs, limbs, other.limbs);
+        return result;
+    }
+
+    constexpr FixedBigInt operator-() const
+    {
+        return FixedBigInt() - *this;
+    }
+
+    constexpr FixedBigInt operator*(const FixedBigInt &other) const
+    {
+        FixedBigInt result;
+        mul_limbs(result.limbs, limbs, other.limbs);
+        return result;
+    }
+
+    // Полное произведение без переполнения
+    constexpr FixedBigInt<2 * Bits> mul_wide(const FixedBigInt &other) const
+    {
+        FixedBigInt<2 * Bits> a(*this), b(other);
+        return a * b;
+    }
+
+    constexpr FixedBigInt operator/(const FixedBigInt &other) const
+    {
+        FixedBigInt quotient, remainder;
+        divmod(*this, other, quotient, remainder);
+        return quotient;
+    }
+
+    constexpr FixedBigInt operator%(const FixedBigInt &other) const
+    {
+        FixedBigInt quotient, remainder;
+        divmod(*this, other, quotient, remainder);
+        return remainder;
+    }
+
+    constexpr FixedBigInt operator<<(size_t shift) const
+    {
+        FixedBigInt result;
+        if (shift >= Bits)
+        {
+            return result;
+        }
+        const size_t words = shift / 64, bits = shift % 64;
+        for (size_t i = LIMBS; i-- > words;)
+        {
+            result.limbs[i] = limbs[i - words] << bits;
+            if (bits != 0 && i > words)
+            {
+                result.limbs[i] |= limbs[i - words - 1] >> (64 - bits);
+            }
+        }
+        return result;
+    }
+
+    constexpr FixedBigInt operator>>(size_t shift) const
+    {
+        FixedBigInt result;
+        if (shift >= Bits)
+        {
+            return result;
+        }
+        const size_t words = shift / 64, bits = shift % 64;
+        for (size_t i = 0; i + words < LIMBS; i++)
+        {
+            result.limbs[i] = limbs[i + words] >> bits;
+            if (bits != 0 && i + words + 1 < LIMBS)
+            {
+                result.limbs[i] |= limbs[i + words + 1] << (64 - bits);
+            }
+        }
+        return result;
+    }
+
+    constexpr FixedBigInt operator&(const FixedBigInt &other) const
+    {
+        FixedBigInt result;
+        for (size_t i = 0; i < LIMBS; i++)
+        {
+            result.limbs[i] = limbs[i] & other.limbs[i];
+        }
+        return result;
+    }
+
+    constexpr FixedBigInt operator|(const FixedBigInt &other) const
+    {
+        FixedBigInt result;
+        for (size_t i = 0; i < LIMBS; i++)
+        {
+            result.limbs[i] = limbs[i] | other.limbs[i];
+        }
+        return result;
+    }
+
+    constexpr FixedBigInt operator^(const FixedBigInt &other) const
+    {
+        FixedBigInt result;
+        for (size_t i = 0; i < LIMBS; i++)
+        {
+            result.limbs[i] = limbs[i] ^ other.limbs[i];
+        }
+        return result;
+    }
+
+    constexpr FixedBigInt operator~() const
+    {
+        FixedBigInt result;
+        for (size_t i = 0; i < LIMBS; i++)
+        {
+            result.limbs[i] = ~limbs[i];
+        }
+        return result;
+    }
+
+    constexpr FixedBigInt &operator+=(const FixedBigInt &other)
+    {
+        add_limbs(limbs, limbs, other.limbs);
+        return *this;
+    }
+
+    constexpr FixedBigInt &operator-=(const FixedBigInt &other)
+    {
+        sub_limbs(limbs, limbs, other.limbs);
+        return *this;
+    }
+
+    constexpr FixedBigInt &operator*=(const FixedBigInt &other)
+    {
+        *this = *this * other;
+        return *this;
+    }
+
+    constexpr FixedBigInt &operator/=(const FixedBigInt &other)
+    {
+        *this = *this / other;
+        return *this;
+    }
+
+    constexpr FixedBigInt &operator%=(const FixedBigInt &other)
+    {
+        *this = *this % other;
+        return *this;
+    }
+
+    constexpr FixedBigInt &operator<<=(size_t shift)
+    {
+        *this = *this << shift;
+        return *this;
+    }
+
+    constexpr FixedBigInt &operator>>=(size_t shift)
+    {
+        *this = *this >> shift;
+        return *this;
+    }
+
+    constexpr FixedBigInt &operator++()
+    {
+        for (size_t i = 0; i < LIMBS && ++limbs[i] == 0; i++)
+        {
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt operator++(int)
+    {
+        FixedBigInt result = *this;
+        ++(*this);
+        return result;
+    }
+
+    constexpr FixedBigInt &operator--()
+    {
+        for (size_t i = 0; i < LIMBS && limbs[i]-- == 0; i++)
+        {
+        }
+        return *this;
+    }
+
+    constexpr FixedBigInt operator--(int)
+    {
+        FixedBigInt result = *this;
+        --(*this);
+        return result;
+    }
+
+    constexpr bool operator==(const FixedBigInt &other) const
+    {
+        return equal_limbs(limbs, other.limbs);
+    }
+
+    constexpr std::strong_ordering operator<=>(const FixedBigInt &other) const
+    {
+        return compare_limbs(limbs, other.limbs);
+    }
+
+    constexpr bool is_zero() const
+    {
+        return is_zero_limbs(limbs);
+    }
+
+    constexpr bool is_odd() const
+    {
+        return limbs[0] & 1;
+    }
+
+    constexpr bool bit(size_t i) const
+    {
+        return i < Bits && ((limbs[i / 64] >> (i % 64)) & 1);
+    }
+
+    constexpr size_t bit_length() const
+    {
+        for (size_t i = LIMBS; i-- > 0;)
+        {
+            if (limbs[i] != 0)
+            {
+                return i * 64 + 64 - std::countl_zero(limbs[i]);
+            }
+        }
+        return 0;
+    }
+
+    constexpr const Limbs &data() const
+    {
+        return limbs;
+    }
+
+    // Нечётная часть модуля - умножением Монтгомери той же ширины, степень двойки - умножением по модулю 2^Bits,
+    // результаты склеиваются по КТО. Удвоенной разрядности и деления в цикле нет.
+    constexpr FixedBigInt mod_exp(const FixedBigInt &exp, const FixedBigInt &mod) const
+    {
+        if (mod.is_zero())
+        {
+            throw std::exception();
+        }
+        size_t twos = 0;
+        while (!mod.bit(twos))
+        {
+            ++twos;
+        }
+        const FixedBigInt odd = mod >> twos;
+        FixedBigInt odd_part;
+        if (odd != FixedBigInt(1))
+        {
+            const FixedMontgomeryParams<Bits> params(odd);
+            odd_part = params.from_montgomery(pow_limbs(params.to_montgomery(*this), exp, params.r_mod, [&params](const FixedBigInt &a, const FixedBigInt &b)
+                                                        { return params.multiply(a, b); }));
+        }
+        if (twos == 0)
+        {
+            return odd_part;
+        }
+        // x = odd_part + odd * ((two_part - odd_part) * odd^(-1) mod 2^twos) < mod
+        const FixedBigInt mask = (FixedBigInt(1) << twos) - FixedBigInt(1);
+        const FixedBigInt two_part = pow_limbs(*this, exp, FixedBigInt(1), [](const FixedBigInt &a, const FixedBigInt &b)
+                                               { return a * b; });
+        FixedBigInt inverse = odd;
+        for (size_t precision = 3; precision < Bits; precision *= 2)
+        {
+            inverse *= FixedBigInt(2) - odd * inverse;
+        }
+        return odd_part + odd * (((two_part - odd_part) * inverse) & mask);
+    }
+
+    static constexpr void swap(FixedBigInt &first, FixedBigInt &second)
+    {
+        std::swap(first.limbs, second.limbs);
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const FixedBigInt &num)
+    {
+        return os << num.to_bigint();
+    }
+
+    friend std::istream &operator>>(std::istream &is, FixedBigInt &num)
+    {
+        BigInt value;
+        is >> value;
+        num = FixedBigInt(value);
+        return is;
+    }
+
+private:
+    __extension__ using uint128 = unsigned __int128;
+
+    static constexpr uint64_t add_step(uint64_t a, uint64_t b, uint64_t &carry)
+    {
+        uint128 sum = (uint128)a + b + carry;
+        carry = (uint64_t)(sum >> 64);
+        return (uint64_t)sum;
+    }
+
+    static constexpr uint64_t sub_step(uint64_t a, uint64_t b, uint64_t &borrow)
+    {
+        uint128 diff = (uint128)a - b - borrow;
+        borrow = (uint64_t)(diff >> 64) & 1;
+        return (uint64_t)diff;
+    }
+
+    static constexpr uint64_t mul_add_step(uint64_t a, uint64_t b, uint64_t add, uint64_t &carry)
+    {
+        uint128 cur = (uint128)a * b + add + carry;
+        carry = (uint64_t)(cur >> 64);
+        return (uint64_t)cur;
+    }
+
+    static constexpr bool UNROLLED = LIMBS <= UNROLL_LIMBS;
+
+    template <size_t... I>
+    static constexpr void add_limbs(Limbs &r, const Limbs &a, const Limbs &b, std::index_sequence<I...>)
+    {
+        uint64_t carry = 0;
+        ((r[I] = add_step(a[I], b[I], carry)), ...);
+    }
+
+    static constexpr void add_limbs(Limbs &r, const Limbs &a, const Limbs &b)
+    {
+        if constexpr (UNROLLED)
+        {
+            add_limbs(r, a, b, std::make_index_sequence<LIMBS>{});
+        }
+        else
+        {
+            uint64_t carry = 0;
+            for (size_t i = 0; i < LIMBS; i++)
+            {
+                r[i] = add_step(a[i], b[i], carry);
+            }
+        }
+    }
+
+    template <size_t... I>
+    static constexpr void sub_limbs(Limbs &r, const Limbs &a, const Limbs &b, std::index_sequence<I...>)
+    {
+        uint64_t borrow = 0;
+        ((r[I] = sub_step(a[I], b[I], borrow)), ...);
+    }
+
+    static constexpr void sub_limbs(Limbs &r, const Limbs &a, const Limbs &b)
+    {
+        if constexpr (UNROLLED)
+        {
+            sub_limbs(r, a, b, std::make_index_sequence<LIMBS>{});
+        }
+        else
+        {
+            uint64_t borrow = 0;
+            for (size_t i = 0; i < LIMBS; i++)
+            {
+                r[i] = sub_step(a[i], b[i], borrow);
+            }
+        }
+    }
+
+    // Строка I произведения: r[I + J] += a[J] * b[I], всё, что старше LIMBS, отбрасывается
+    template <size_t I, size_t... J>
+    static constexpr void mul_row(Limbs &r, const Limbs &a, uint64_t b, std::index_sequence<J...>)
+    {
+        uint64_t carry = 0;
+        ((r[I + J] = mul_add_step(a[J], b, r[I + J], carry)), ...);
+    }
+
+    template <size_t... I>
+    static constexpr void mul_limbs(Limbs &r, const Limbs &a, const Limbs &b, std::index_sequence<I...>)
+    {
+        Limbs result{};
+        (mul_row<I>(result, a, b[I], std::make_index_sequence<LIMBS - I>{}), ...);
+        r = result;
+    }
+
+    static constexpr void mul_limbs(Limbs &r, const Limbs &a, const Limbs &b)
+    {
+        if constexpr (UNROLLED)
+        {
+            mul_limbs(r, a, b, std::make_index_sequence<LIMBS>{});
+        }
+        else
+        {
+            Limbs result{};
+            for (size_t i = 0; i < LIMBS; i++)
+            {
+                uint64_t carry = 0;
+                for (size_t j = 0; i + j < LIMBS; j++)
+                {
+                    result[i + j] = mul_add_step(a[j], b[i], result[i + j], carry);
+                }
+            }
+            r = result;
+        }
+    }
+
+    template <size_t... I>
+    static constexpr bool equal_limbs(const Limbs &a, const Limbs &b, std::index_sequence<I...>)
+    {
+        return ((a[I] == b[I]) && ...);
+    }
+
+    static constexpr bool equal_limbs(const Limbs &a, const Limbs &b)
+    {
+        if constexpr (UNROLLED)
+        {
+            return equal_limbs(a, b, std::make_index_sequence<LIMBS>{});
+        }
+        return a == b;
+    }
+
+    template <size_t... I>
+    static constexpr std::strong_ordering compare_limbs(const Limbs &a, const Limbs &b, std::index_sequence<I...>)
+    {
+        std::strong_ordering result = std::strong_ordering::equal;
+        ((a[LIMBS - 1 - I] != b[LIMBS - 1 - I] ? (result = a[LIMBS - 1 - I] <=> b[LIMBS - 1 - I], true) : false) || ...);
+        return result;
+    }
+
+    static constexpr std::strong_ordering compare_limbs(const Limbs &a, const Limbs &b)
+    {
+        if constexpr (UNROLLED)
+        {
+            return compare_limbs(a, b, std::make_index_sequence<LIMBS>{});
+        }
+        for (size_t i = LIMBS; i-- > 0;)
+        {
+            if (a[i] != b[i])
+            {
+                return a[i] <=> b[i];
+            }
+        }
+        return std::strong_ordering::equal;
+    }
+
+    // base^exp слева направо; one - единица в представлении multiply
+    template <typename Multiply>
+    static constexpr FixedBigInt pow_limbs(const FixedBigInt &base, const FixedBigInt &exp, const FixedBigInt &one, const Multiply &multiply)
+    {
+        FixedBigInt result = one;
+        for (size_t i = exp.bit_length(); i-- > 0;)
+        {
+            result = multiply(result, result);
+            if (exp.bit(i))
+            {
+                result = multiply(result, base);
+            }
+        }
+        return result;
+    }
+
+    static constexpr bool is_zero_limbs(const Limbs &a)
+    {
+        for (uint64_t limb : a)
+        {
+            if (limb != 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // a = a * m + add
+    static constexpr void mul_add_1(Limbs &a, uint64_t m, uint64_t add)
+    {
+        uint64_t carry = add;
+        for (size_t i = 0; i < LIMBS; i++)
+        {
+            a[i] = mul_add_step(a[i], m, 0, carry);
+        }
+    }
+
+    // a /= d, возвращает остаток
+    static constexpr uint64_t divrem_1(Limbs &a, uint64_t d)
+    {
+        uint64_t rem = 0;
+        for (size_t i = LIMBS; i-- > 0;)
+        {
+            uint128 cur = ((uint128)rem << 64) | a[i];
+            a[i] = (uint64_t)(cur / d);
+            rem = (uint64_t)(cur % d);
+        }
+        return rem;
+    }
+
+    // Деление столбиком по 64-битным разрядам (Кнут, алгоритм D)
+    static constexpr void divmod(const FixedBigInt &a, const FixedBigInt &b, FixedBigInt &quotient, FixedBigInt &remainder)
+    {
+        size_t n = LIMBS;
+        while (n > 0 && b.limbs[n - 1] == 0)
+        {
+            --n;
+        }
+        if (n == 0)
+        {
+            throw std::exception();
+        }
+        quotient = FixedBigInt();
+        if (a < b)
+        {
+            remainder = a;
+            return;
+        }
+        if (n == 1)
+        {
+            quotient = a;
+            remainder = FixedBigInt(divrem_1(quotient.limbs, b.limbs[0]));
+            return;
+        }
+
+        const int shift = std::countl_zero(b.limbs[n - 1]);
+        std::array<uint64_t, LIMBS + 1> u{};
+        Limbs v = (b << shift).limbs;
+        for (size_t i = 0; i < LIMBS; i++)
+        {
+            u[i] = a.limbs[i] << shift;
+            if (shift != 0 && i > 0)
+            {
+                u[i] |= a.limbs[i - 1] >> (64 - shift);
+            }
+        }
+        u[LIMBS] = shift != 0 ? a.limbs[LIMBS - 1] >> (64 - shift) : 0;
+
+        for (size_t j = LIMBS - n + 1; j-- > 0;)
+        {
+            uint128 num = ((uint128)u[j + n] << 64) | u[j + n - 1];
+            uint128 qhat = num / v[n - 1], rhat = num % v[n - 1];
+            while ((qhat >> 64) != 0 || qhat * v[n - 2] > ((rhat << 64) | u[j + n - 2]))
+            {
+                --qhat;
+                rhat += v[n - 1];
+                if ((rhat >> 64) != 0)
+                {
+                    break;
+                }
+            }
+
+            uint64_t borrow = 0, carry = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                uint64_t product = mul_add_step(v[i], (uint64_t)qhat, 0, carry);
+                u[i + j] = sub_step(u[i + j], product, borrow);
+            }
+            u[j + n] = sub_step(u[j + n], carry, borrow);
+            if (borrow)
+            {
+                --qhat;
+                carry = 0;
+                for (size_t i = 0; i < n; i++)
+                {
+                    u[i + j] = add_step(u[i + j], v[i], carry);
+                }
+                u[j + n] += carry;
+            }
+            quotient.limbs[j] = (uint64_t)qhat;
+        }
+
+        remainder = FixedBigInt();
+        for (size_t i = 0; i < n; i++)
+        {
+            remainder.limbs[i] = u[i] >> shift;
+            if (shift != 0)
+            {
+                remainder.limbs[i] |= u[i + 1] << (64 - shift);
+            }
+        }
+    }
+
+    Limbs limbs;
+};
+
+// Параметры Монтгомери для нечётного модуля при R = 2^Bits, считаются в том числе на этапе компиляции
+template <size_t Bits>
+struct FixedMontgomeryParams
+{
+    FixedBigInt<Bits> modulus, r_mod, r2_mod;
+    uint64_t inv = 0; // -modulus^(-1) mod 2^64
+
+    constexpr explicit FixedMontgomeryParams(const FixedBigInt<Bits> &_modulus) : modulus(_modulus)
+    {
+        if (!modulus.is_odd())
+        {
+            throw std::exception();
+        }
+        const uint64_t m0 = modulus.data()[0];
+        uint64_t x = m0;
+        for (int i = 0; i < 6; i++)
+        {
+            x *= 2 - m0 * x;
+        }
+        inv = ~x + 1;
+        r_mod = (FixedBigInt<Bits>() - modulus) % modulus;
+        // R^2 = R * 2^Bits: Bits удвоений по модулю вместо умножения удвоенной ширины
+        r2_mod = r_mod;
+        for (size_t i = 0; i < Bits; i++)
+        {
+            const bool carry = r2_mod.bit(Bits - 1);
+            r2_mod <<= 1;
+            if (carry || r2_mod >= modulus)
+            {
+                r2_mod -= modulus;
+            }
+        }
+    }
+
+    // a * b / R mod modulus
+    constexpr FixedBigInt<Bits> multiply(const FixedBigInt<Bits> &a, const FixedBigInt<Bits> &b) const
+    {
+        __extension__ using uint128 = unsigned __int128;
+        constexpr size_t n = FixedBigInt<Bits>::LIMBS;
+        const auto &x = a.data(), &y = b.data(), &m = modulus.data();
+        std::array<uint64_t, n + 2> t{};
+        for (size_t i = 0; i < n; i++)
+        {
+            uint128 cur = 0;
+            for (size_t j = 0; j < n; j++)
+            {
+                cur = (uint128)x[j] * y[i] + t[j] + (uint64_t)(cur >> 64);
+                t[j] = (uint64_t)cur;
+            }
+            cur = (uint128)t[n] + (uint64_t)(cur >> 64);
+            t[n] = (uint64_t)cur;
+            t[n + 1] = (uint64_t)(cur >> 64);
+
+            const uint64_t u = t[0] * inv;
+            cur = (uint128)u * m[0] + t[0];
+            for (size_t j = 1; j < n; j++)
+            {
+                cur = (uint128)u * m[j] + t[j] + (uint64_t)(cur >> 64);
+                t[j - 1] = (uint64_t)cur;
+            }
+            cur = (uint128)t[n] + (uint64_t)(cur >> 64);
+            t[n - 1] = (uint64_t)cur;
+            t[n] = t[n + 1] + (uint64_t)(cur >> 64);
+        }
+
+        FixedBigInt<Bits> result;
+        for (size_t i = 0; i < n; i++)
+        {
+            result.limbs[i] = t[i];
+        }
+        if (t[n] != 0 || result >= modulus)
+        {
+            result -= modulus;
+        }
+        return result;
+    }
+
+    constexpr FixedBigInt<Bits> to_montgomery(const FixedBigInt<Bits> &a) const
+    {
+        return multiply(a % modulus, r2_mod);
+    }
+
+    constexpr FixedBigInt<Bits> from_montgomery(const FixedBigInt<Bits> &a) const
+    {
+        return multiply(a, FixedBigInt<Bits>(1));
+    }
+};
+
+// Разбор литерала _big во время компиляции: десятичные, 0x, 0b и восьмеричные с ведущим нулём,
+// разделители ' пропускаются. Разрядность - наименьшая кратная 64, вмещающая все цифры.
+template <char... Chars>
+struct FixedBigIntLiteral
+{
+    static constexpr char chars[] = {Chars...};
+    static constexpr size_t count = sizeof...(Chars);
+
+    static constexpr unsigned base()
+    {
+        if (count > 2 && chars[0] == '0' && (chars[1] == 'x' || chars[1] == 'X'))
+        {
+            return 16;
+        }
+        if (count > 2 && chars[0] == '0' && (chars[1] == 'b' || chars[1] == 'B'))
+        {
+            return 2;
+        }
+        return (count > 1 && chars[0] == '0') ? 8 : 10;
+    }
+
+    static constexpr size_t prefix()
+    {
+        return base() == 16 || base() == 2 ? 2 : 0;
+    }
+
+    static constexpr size_t bits()
+    {
+        size_t digits = 0;
+        for (size_t i = prefix(); i < count; i++)
+        {
+            digits += chars[i] != '\'';
+        }
+        const size_t value_bits = base() == 10 ? (digits * 3322 + 999) / 1000 : digits * std::countr_zero(base());
+        return std::max<size_t>(64, (value_bits + 63) / 64 * 64);
+    }
+
+    static constexpr unsigned digit(char c)
+    {
+        unsigned d = (c >= '0' && c <= '9') ? c - '0' : ((c >= 'a' && c <= 'f') ? c - 'a' + 10 : ((c >= 'A' && c <= 'F') ? c - 'A' + 10 : 16));
+        if (d >= base())
+        {
+            throw std::exception();
+        }
+        return d;
+    }
+
+    static constexpr FixedBigInt<bits()> parse()
+    {
+        FixedBigInt<bits()> result;
+        for (size_t i = prefix(); i < count; i++)
+        {
+            if (chars[i] != '\'')
+            {
+                result = result * FixedBigInt<bits()>(base()) + FixedBigInt<bits()>(digit(chars[i]));
+            }
+        }
+        return result;
+    }
+};
+
+template <char... Chars>
+consteval auto operator""_big()
+{
+    return FixedBigIntLiteral<Chars...>::parse();
+}
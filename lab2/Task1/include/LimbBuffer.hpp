@@ -0,0 +1,318 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#ifdef BIGINT_NO_COW
+
+// Без copy-on-write разряды - обычный вектор, каждая копия BigInt копирует их сразу
+using LimbBuffer = std::vector<unsigned long long>;
+
+inline std::vector<unsigned long long> &limbs_for_write(LimbBuffer &buffer)
+{
+    return buffer;
+}
+
+#else
+
+// Разряды BigInt в общем буфере с атомарным счётчиком ссылок: копия стоит O(1), а разряды
+// копируются при первой записи в буфер, которым владеет кто-то ещё (copy-on-write).
+// Интерфейс - подмножество std::vector, поэтому при BIGINT_NO_COW буфер заменяется вектором.
+// Неконстантные begin/end/operator[] сначала отделяют буфер, так что итераторы и ссылки на разряды
+// нельзя держать через копирование самого буфера
+class LimbBuffer
+{
+public:
+    using vector_type = std::vector<unsigned long long>;
+    using value_type = unsigned long long;
+    using size_type = size_t;
+    using reference = unsigned long long &;
+    using const_reference = const unsigned long long &;
+    using iterator = vector_type::iterator;
+    using const_iterator = vector_type::const_iterator;
+    using reverse_iterator = vector_type::reverse_iterator;
+    using const_reverse_iterator = vector_type::const_reverse_iterator;
+
+    LimbBuffer() = default;
+
+    LimbBuffer(vector_type limbs) : _block(new Block{{1}, std::move(limbs)})
+    {
+    }
+
+    LimbBuffer(std::initializer_list<unsigned long long> limbs) : LimbBuffer(vector_type(limbs))
+    {
+    }
+
+    LimbBuffer(size_t count, unsigned long long value) : LimbBuffer(vector_type(count, value))
+    {
+    }
+
+    template <std::input_iterator It>
+    LimbBuffer(It first, It last) : LimbBuffer(vector_type(first, last))
+    {
+    }
+
+    LimbBuffer(const LimbBuffer &other) noexcept : _block(other._block)
+    {
+        if (_block != nullptr)
+        {
+            _block->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    LimbBuffer(LimbBuffer &&other) noexcept : _block(std::exchange(other._block, nullptr))
+    {
+    }
+
+    LimbBuffer &operator=(LimbBuffer other) noexcept
+    {
+        std::swap(_block, other._block);
+        return *this;
+    }
+
+    ~LimbBuffer()
+    {
+        release();
+    }
+
+    // Чтение без копирования
+    operator const vector_type &() const
+    {
+        return view();
+    }
+
+    const vector_type &view() const
+    {
+        static const vector_type empty;
+        return _block != nullptr ? _block->limbs : empty;
+    }
+
+    // Вектор только этого буфера: общий буфер копируется
+    vector_type &detach()
+    {
+        if (_block == nullptr)
+        {
+            _block = new Block{{1}, {}};
+        }
+        else if (_block->refs.load(std::memory_order_acquire) != 1)
+        {
+            Block *copy = new Block{{1}, _block->limbs};
+            release();
+            _block = copy;
+        }
+        return _block->limbs;
+    }
+
+    // Число владельцев буфера (0 у пустого)
+    size_t use_count() const
+    {
+        return _block != nullptr ? _block->refs.load(std::memory_order_relaxed) : 0;
+    }
+
+    size_t size() const
+    {
+        return view().size();
+    }
+
+    bool empty() const
+    {
+        return view().empty();
+    }
+
+    const unsigned long long *data() const
+    {
+        return view().data();
+    }
+
+    unsigned long long *data()
+    {
+        return detach().data();
+    }
+
+    const unsigned long long &operator[](size_t i) const
+    {
+        return view()[i];
+    }
+
+    unsigned long long &operator[](size_t i)
+    {
+        return detach()[i];
+    }
+
+    const unsigned long long &front() const
+    {
+        return view().front();
+    }
+
+    unsigned long long &front()
+    {
+        return detach().front();
+    }
+
+    const unsigned long long &back() const
+    {
+        return view().back();
+    }
+
+    unsigned long long &back()
+    {
+        return detach().back();
+    }
+
+    const_iterator begin() const
+    {
+        return view().begin();
+    }
+
+    const_iterator end() const
+    {
+        return view().end();
+    }
+
+    iterator begin()
+    {
+        return detach().begin();
+    }
+
+    iterator end()
+    {
+        return detach().end();
+    }
+
+    const_iterator cbegin() const
+    {
+        return begin();
+    }
+
+    const_iterator cend() const
+    {
+        return end();
+    }
+
+    const_reverse_iterator rbegin() const
+    {
+        return view().rbegin();
+    }
+
+    const_reverse_iterator rend() const
+    {
+        return view().rend();
+    }
+
+    reverse_iterator rbegin()
+    {
+        return detach().rbegin();
+    }
+
+    reverse_iterator rend()
+    {
+        return detach().rend();
+    }
+
+    void push_back(unsigned long long limb)
+    {
+        detach().push_back(limb);
+    }
+
+    void pop_back()
+    {
+        detach().pop_back();
+    }
+
+    void resize(size_t count, unsigned long long value = 0)
+    {
+        detach().resize(count, value);
+    }
+
+    void reserve(size_t count)
+    {
+        detach().reserve(count);
+    }
+
+    // Очистка и присваивание не копируют общий буфер, а просто отпускают его
+    void clear()
+    {
+        release();
+    }
+
+    void assign(size_t count, unsigned long long value)
+    {
+        *this = LimbBuffer(count, value);
+    }
+
+    template <std::input_iterator It>
+    void assign(It first, It last)
+    {
+        *this = LimbBuffer(first, last);
+    }
+
+    void assign(std::initializer_list<unsigned long long> limbs)
+    {
+        *this = LimbBuffer(limbs);
+    }
+
+    iterator insert(const_iterator pos, unsigned long long limb)
+    {
+        const auto offset = pos - view().begin();
+        vector_type &limbs = detach();
+        return limbs.insert(limbs.begin() + offset, limb);
+    }
+
+    template <std::input_iterator It>
+    iterator insert(const_iterator pos, It first, It last)
+    {
+        const auto offset = pos - view().begin();
+        vector_type &limbs = detach();
+        return limbs.insert(limbs.begin() + offset, first, last);
+    }
+
+    iterator erase(const_iterator first, const_iterator last)
+    {
+        const auto from = first - view().begin(), to = last - view().begin();
+        vector_type &limbs = detach();
+        return limbs.erase(limbs.begin() + from, limbs.begin() + to);
+    }
+
+    void swap(LimbBuffer &other) noexcept
+    {
+        std::swap(_block, other._block);
+    }
+
+    void swap(vector_type &other)
+    {
+        detach().swap(other);
+    }
+
+    bool operator==(const LimbBuffer &other) const
+    {
+        return _block == other._block || view() == other.view();
+    }
+
+private:
+    struct Block
+    {
+        std::atomic<size_t> refs;
+        vector_type limbs;
+    };
+
+    void release() noexcept
+    {
+        if (_block != nullptr && _block->refs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete _block;
+        }
+        _block = nullptr;
+    }
+
+    Block *_block = nullptr;
+};
+
+inline std::vector<unsigned long long> &limbs_for_write(LimbBuffer &buffer)
+{
+    return buffer.detach();
+}
+
+#endif
@@ -0,0 +1,558 @@
+#pragma once
+#include "BigIntFile.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Умножение чисел, которые не помещаются в оперативную память. Операнды и результат - файлы
+// формата BigIntFile (MappedBigInt), промежуточные спектры - временные файлы, отображённые через mmap.
+// Свёртка разрядов считается NTT по двум 62-битным простым с восстановлением по КТО; преобразование
+// длины N = rows * cols разбито четырёхшаговой схемой на короткие NTT столбцов и строк, так что
+// за раз в памяти лежит не больше memory_budget байт, а прочитанные страницы сразу отпускаются
+class OutOfCoreMultiplier
+{
+public:
+    // Наименьший бюджет: при нём столбец и строка по 512 слов, N до 2^18
+    static constexpr size_t MIN_BUDGET = size_t(16) << 10;
+
+    struct Options
+    {
+        size_t memory_budget = size_t(256) << 20;
+        std::string temp_dir = "/tmp";
+    };
+
+    OutOfCoreMultiplier() = default;
+
+    explicit OutOfCoreMultiplier(Options options) : _options(std::move(options))
+    {
+        if (_options.memory_budget < MIN_BUDGET)
+        {
+            throw std::exception();
+        }
+    }
+
+    const Options &options() const
+    {
+        return _options;
+    }
+
+    // a * b в файл out_path (формат BigIntFile); результат - отображение этого файла
+    MappedBigInt multiply(const MappedBigInt &a, const MappedBigInt &b, const std::string &out_path) const
+    {
+        std::span<const unsigned long long> x = a.limbs(), y = b.limbs();
+        const bool negative = a.is_negative() != b.is_negative();
+        if (is_zero(x) || is_zero(y))
+        {
+            BigIntFile::save(out_path, BigInt(0));
+            return MappedBigInt(out_path);
+        }
+
+        // Небольшие операнды умножаются в памяти; множитель - запас на буферы FFT
+        const size_t length = x.size() + y.size();
+        if (length * sizeof(uint64_t) * IN_CORE_FACTOR <= _options.memory_budget)
+        {
+            BigIntFile::save(out_path, a.to_bigint().karatsuba_multiply(b.to_bigint()));
+            return MappedBigInt(out_path);
+        }
+
+        const Layout layout = plan(length);
+        const bool square = x.data() == y.data() && x.size() == y.size();
+        Mapping low = Mapping::temporary(_options.temp_dir, layout.size * sizeof(uint64_t));
+        Mapping high = Mapping::temporary(_options.temp_dir, layout.size * sizeof(uint64_t));
+        Mapping scratch = square ? Mapping() : Mapping::temporary(_options.temp_dir, layout.size * sizeof(uint64_t));
+        convolve(PRIMES[0], x, y, square, low, scratch, layout);
+        convolve(PRIMES[1], x, y, square, high, scratch, layout);
+        scratch = Mapping();
+        write_product(low, high, length, negative, out_path, layout.block);
+        return MappedBigInt(out_path);
+    }
+
+    MappedBigInt multiply(const std::string &a_path, const std::string &b_path, const std::string &out_path) const
+    {
+        MappedBigInt a(a_path);
+        if (a_path == b_path)
+        {
+            return multiply(a, a, out_path);
+        }
+        return multiply(a, MappedBigInt(b_path), out_path);
+    }
+
+private:
+    __extension__ using uint128 = unsigned __int128;
+
+    static constexpr size_t IN_CORE_FACTOR = 32;
+
+    // Простое p = c * 2^k + 1 с первообразным корнем g; арифметика по Монтгомери с R = 2^64.
+    // Данные хранятся обычными вычетами, корни и множители - в форме Монтгомери,
+    // тогда mul(данное, корень) сразу даёт обычный вычет
+    struct Prime
+    {
+        uint64_t p, g;
+        uint64_t neg_inv; // -p^(-1) mod 2^64
+        uint64_t one;     // 2^64 mod p - единица в форме Монтгомери
+        uint64_t r2;      // 2^128 mod p
+
+        constexpr Prime(uint64_t modulus, uint64_t generator) : p(modulus), g(generator), neg_inv(0), one(0), r2(0)
+        {
+            uint64_t inv = p;
+            for (int i = 0; i < 5; i++)
+            {
+                inv *= 2 - p * inv;
+            }
+            neg_inv = 0 - inv;
+            one = (uint64_t)(((uint128)1 << 64) % p);
+            r2 = (uint64_t)((uint128)one * one % p);
+        }
+
+        uint64_t mul(uint64_t a, uint64_t b) const
+        {
+            const uint128 t = (uint128)a * b;
+            const uint64_t m = (uint64_t)t * neg_inv;
+            const uint64_t u = (uint64_t)((t + (uint128)m * p) >> 64);
+            return u >= p ? u - p : u;
+        }
+
+        uint64_t add(uint64_t a, uint64_t b) const
+        {
+            const uint64_t s = a + b;
+            return s >= p ? s - p : s;
+        }
+
+        uint64_t sub(uint64_t a, uint64_t b) const
+        {
+            return a >= b ? a - b : a + p - b;
+        }
+
+        uint64_t to_montgomery(uint64_t a) const
+        {
+            return mul(a, r2);
+        }
+
+        // base в форме Монтгомери, результат - тоже
+        uint64_t pow(uint64_t base, uint64_t exp) const
+        {
+            uint64_t result = one;
+            for (; exp != 0; exp >>= 1)
+            {
+                if (exp & 1)
+                {
+                    result = mul(result, base);
+                }
+                base = mul(base, base);
+            }
+            return result;
+        }
+
+        // Корень степени n из единицы в форме Монтгомери
+        uint64_t root(uint64_t n, bool inverse) const
+        {
+            const uint64_t w = pow(to_montgomery(g), (p - 1) / n);
+            return inverse ? pow(w, n - 1) : w;
+        }
+    };
+
+    // Произведение двух простых ~2^123 покрывает коэффициенты свёртки n * (10^9)^2 при n < 2^63
+    static inline const Prime PRIMES[2] = {Prime(4179340454199820289ULL, 3), Prime(2485986994308513793ULL, 5)};
+
+    // Матрица rows x cols, построчно: элемент n = n1 + cols * n2 лежит в строке n2, столбце n1.
+    // block - размер рабочего буфера в словах
+    struct Layout
+    {
+        size_t size, rows, cols, block;
+    };
+
+    // Отображённый в память файл; временный удаляется сразу после создания
+    class Mapping
+    {
+    public:
+        Mapping() = default;
+
+        static Mapping temporary(const std::string &dir, size_t bytes)
+        {
+            std::string pattern = dir + "/bigint_ooc_XXXXXX";
+            int fd = ::mkstemp(pattern.data());
+            if (fd < 0)
+            {
+                throw std::exception();
+            }
+            ::unlink(pattern.c_str());
+            return Mapping(fd, bytes);
+        }
+
+        static Mapping create(const std::string &path, size_t bytes)
+        {
+            int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (fd < 0)
+            {
+                throw std::exception();
+            }
+            return Mapping(fd, bytes);
+        }
+
+        Mapping(const Mapping &) = delete;
+        Mapping &operator=(const Mapping &) = delete;
+
+        Mapping(Mapping &&other) noexcept
+            : _fd(std::exchange(other._fd, -1)), _address(std::exchange(other._address, nullptr)), _size(std::exchange(other._size, 0))
+        {
+        }
+
+        Mapping &operator=(Mapping &&other) noexcept
+        {
+            if (this != &other)
+            {
+                close();
+                _fd = std::exchange(other._fd, -1);
+                _address = std::exchange(other._address, nullptr);
+                _size = std::exchange(other._size, 0);
+            }
+            return *this;
+        }
+
+        ~Mapping()
+        {
+            close();
+        }
+
+        char *bytes() const
+        {
+            return static_cast<char *>(_address);
+        }
+
+        uint64_t *words() const
+        {
+            return reinterpret_cast<uint64_t *>(_address);
+        }
+
+        // Уменьшение файла; отображение остаётся прежней длины, хвост за новым концом не трогается
+        void truncate(size_t bytes)
+        {
+            if (::ftruncate(_fd, (off_t)bytes) != 0)
+            {
+                throw std::exception();
+            }
+        }
+
+        // Страницы внутри [offset, offset + length) байт больше не занимают память процесса;
+        // изменённые данные остаются в файле
+        void release(size_t offset, size_t length) const
+        {
+            release_pages(bytes() + offset, length);
+        }
+
+        void release() const
+        {
+            release(0, _size);
+        }
+
+    private:
+        Mapping(int fd, size_t bytes) : _fd(fd), _size(bytes)
+        {
+            if (::ftruncate(_fd, (off_t)bytes) != 0)
+            {
+                close();
+                throw std::exception();
+            }
+            void *address = ::mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, 0);
+            if (address == MAP_FAILED)
+            {
+                close();
+                throw std::exception();
+            }
+            _address = address;
+        }
+
+        void close() noexcept
+        {
+            if (_address != nullptr)
+            {
+                ::munmap(_address, _size);
+                _address = nullptr;
+            }
+            if (_fd >= 0)
+            {
+                ::close(_fd);
+                _fd = -1;
+            }
+        }
+
+        int _fd = -1;
+        void *_address = nullptr;
+        size_t _size = 0;
+    };
+
+    static void release_pages(const void *address, size_t length)
+    {
+        const uintptr_t page = (uintptr_t)::sysconf(_SC_PAGESIZE);
+        const uintptr_t begin = ((uintptr_t)address + page - 1) / page * page, end = ((uintptr_t)address + length) / page * page;
+        if (begin < end)
+        {
+            ::madvise(reinterpret_cast<void *>(begin), end - begin, MADV_DONTNEED);
+        }
+    }
+
+    static bool is_zero(std::span<const unsigned long long> limbs)
+    {
+        return limbs.size() == 1 && limbs.front() == 0;
+    }
+
+    // Рабочий буфер - четверть бюджета; остальное - таблицы корней и страницы отображений.
+    // Строка целиком помещается в буфер, столбец - тоже, отсюда предел N <= block^2
+    Layout plan(size_t length) const
+    {
+        Layout layout;
+        layout.size = std::bit_ceil(length);
+        layout.block = std::bit_floor(_options.memory_budget / sizeof(uint64_t) / 4);
+        layout.cols = std::min(layout.size, layout.block);
+        layout.rows = layout.size / layout.cols;
+        if (layout.rows > layout.block)
+        {
+            throw std::exception();
+        }
+        return layout;
+    }
+
+    // Спектр свёртки a и b по модулю prime в result; scratch - спектр второго множителя
+    void convolve(const Prime &prime, std::span<const unsigned long long> a, std::span<const unsigned long long> b, bool square,
+                  Mapping &result, Mapping &scratch, const Layout &layout) const
+    {
+        load(a, result, layout);
+        transform(prime, result, layout, false);
+        if (!square)
+        {
+            load(b, scratch, layout);
+            transform(prime, scratch, layout, false);
+        }
+
+        // a * b / R, затем * R^2 / R - обычный вычет произведения
+        const Mapping &other = square ? result : scratch;
+        uint64_t *x = result.words();
+        const uint64_t *y = other.words();
+        for (size_t begin = 0; begin < layout.size; begin += layout.block)
+        {
+            const size_t end = std::min(layout.size, begin + layout.block);
+            for (size_t i = begin; i < end; i++)
+            {
+                x[i] = prime.mul(prime.mul(x[i], y[i]), prime.r2);
+            }
+            result.release(begin * sizeof(uint64_t), (end - begin) * sizeof(uint64_t));
+            other.release(begin * sizeof(uint64_t), (end - begin) * sizeof(uint64_t));
+        }
+        transform(prime, result, layout, true);
+    }
+
+    // Разряды старшим первым -> коэффициенты младшим первым, дополненные нулями до N
+    static void load(std::span<const unsigned long long> limbs, const Mapping &target, const Layout &layout)
+    {
+        uint64_t *data = target.words();
+        const size_t count = limbs.size();
+        for (size_t begin = 0; begin < layout.size; begin += layout.block)
+        {
+            const size_t end = std::min(layout.size, begin + layout.block);
+            for (size_t i = begin; i < end; i++)
+            {
+                data[i] = i < count ? (uint64_t)limbs[count - 1 - i] : 0;
+            }
+            target.release(begin * sizeof(uint64_t), (end - begin) * sizeof(uint64_t));
+            if (begin < count)
+            {
+                const size_t last = std::min(count, end);
+                release_pages(limbs.data() + (count - last), (last - begin) * sizeof(uint64_t));
+            }
+        }
+    }
+
+    // Четырёхшаговое NTT длины N = rows * cols:
+    // прямое - NTT столбцов длины rows, умножение элемента (k2, n1) на w_N^(n1 k2), NTT строк длины cols;
+    // элемент (k2, k1) после него - X[k2 + rows * k1]. Обратное проходит те же шаги в обратном порядке
+    // и делит на N, возвращая коэффициенты на их места
+    void transform(const Prime &prime, const Mapping &file, const Layout &layout, bool inverse) const
+    {
+        if (!inverse)
+        {
+            transform_columns(prime, file, layout, false);
+            transform_rows(prime, file, layout, false);
+        }
+        else
+        {
+            transform_rows(prime, file, layout, true);
+            transform_columns(prime, file, layout, true);
+        }
+    }
+
+    // Полосы по band столбцов собираются в буфер (каждая строка даёт band подряд идущих слов)
+    static void transform_columns(const Prime &prime, const Mapping &file, const Layout &layout, bool inverse)
+    {
+        const size_t rows = layout.rows, cols = layout.cols, band = std::max<size_t>(1, layout.block / rows);
+        const std::vector<uint64_t> table = roots(prime, rows, inverse);
+        const uint64_t w = prime.root(layout.size, inverse);
+        const uint64_t scale = prime.pow(prime.to_montgomery(layout.size % prime.p), prime.p - 2);
+        std::vector<uint64_t> buffer(band * rows);
+        uint64_t *data = file.words();
+
+        for (size_t first = 0; first < cols; first += band)
+        {
+            const size_t width = std::min(band, cols - first);
+            for (size_t r = 0; r < rows; r++)
+            {
+                const uint64_t *row = data + r * cols + first;
+                for (size_t c = 0; c < width; c++)
+                {
+                    buffer[c * rows + r] = row[c];
+                }
+            }
+            for (size_t c = 0; c < width; c++)
+            {
+                std::span<uint64_t> column(buffer.data() + c * rows, rows);
+                const uint64_t step = prime.pow(w, first + c);
+                if (!inverse)
+                {
+                    ntt(prime, column, table);
+                    twiddle(prime, column, step, prime.one);
+                }
+                else
+                {
+                    twiddle(prime, column, step, prime.one);
+                    ntt(prime, column, table);
+                    for (uint64_t &x : column)
+                    {
+                        x = prime.mul(x, scale);
+                    }
+                }
+            }
+            for (size_t r = 0; r < rows; r++)
+            {
+                uint64_t *row = data + r * cols + first;
+                for (size_t c = 0; c < width; c++)
+                {
+                    row[c] = buffer[c * rows + r];
+                }
+            }
+            file.release();
+        }
+    }
+
+    // Строки лежат в файле подряд: NTT прямо в отображении, полосами по размеру буфера
+    static void transform_rows(const Prime &prime, const Mapping &file, const Layout &layout, bool inverse)
+    {
+        const size_t rows = layout.rows, cols = layout.cols, band = std::max<size_t>(1, layout.block / cols);
+        const std::vector<uint64_t> table = roots(prime, cols, inverse);
+        uint64_t *data = file.words();
+        for (size_t first = 0; first < rows; first += band)
+        {
+            const size_t last = std::min(rows, first + band);
+            for (size_t r = first; r < last; r++)
+            {
+                ntt(prime, std::span<uint64_t>(data + r * cols, cols), table);
+            }
+            file.release(first * cols * sizeof(uint64_t), (last - first) * cols * sizeof(uint64_t));
+        }
+    }
+
+    // x[k] *= step^k, начиная с множителя current
+    static void twiddle(const Prime &prime, std::span<uint64_t> x, uint64_t step, uint64_t current)
+    {
+        for (uint64_t &value : x)
+        {
+            value = prime.mul(value, current);
+            current = prime.mul(current, step);
+        }
+    }
+
+    // w_n^j для j < n/2 в форме Монтгомери
+    static std::vector<uint64_t> roots(const Prime &prime, size_t n, bool inverse)
+    {
+        std::vector<uint64_t> table(std::max<size_t>(1, n / 2));
+        const uint64_t w = prime.root(n, inverse);
+        table[0] = prime.one;
+        for (size_t j = 1; j < table.size(); j++)
+        {
+            table[j] = prime.mul(table[j - 1], w);
+        }
+        return table;
+    }
+
+    // NTT в памяти: перестановка по обращённым битам и бабочки Кули-Тьюки, результат в естественном порядке
+    static void ntt(const Prime &prime, std::span<uint64_t> a, const std::vector<uint64_t> &table)
+    {
+        const size_t n = a.size();
+        for (size_t i = 1, j = 0; i < n; i++)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j)
+            {
+                std::swap(a[i], a[j]);
+            }
+        }
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            const size_t half = len / 2, step = n / len;
+            for (size_t i = 0; i < n; i += len)
+            {
+                for (size_t j = 0; j < half; j++)
+                {
+                    const uint64_t u = a[i + j], v = prime.mul(a[i + j + half], table[j * step]);
+                    a[i + j] = prime.add(u, v);
+                    a[i + j + half] = prime.sub(u, v);
+                }
+            }
+        }
+    }
+
+    // Восстановление коэффициентов по КТО, перенос по основанию 10^9 и запись разрядов с конца файла
+    static void write_product(const Mapping &low, const Mapping &high, size_t length, bool negative, const std::string &path, size_t block)
+    {
+        const Prime &first = PRIMES[0], &second = PRIMES[1];
+        const uint64_t first_inverse = second.pow(second.to_montgomery(first.p % second.p), second.p - 2);
+        constexpr size_t header_size = sizeof(BigIntFile::Header);
+
+        Mapping out = Mapping::create(path, header_size + length * sizeof(uint64_t));
+        uint64_t *limbs = reinterpret_cast<uint64_t *>(out.bytes() + header_size);
+        const uint64_t *r1 = low.words(), *r2 = high.words();
+        uint128 carry = 0;
+        for (size_t begin = 0; begin < length; begin += block)
+        {
+            const size_t end = std::min(length, begin + block);
+            for (size_t i = begin; i < end; i++)
+            {
+                const uint64_t t = second.mul(second.sub(r2[i], r1[i] % second.p), first_inverse);
+                const uint128 value = (uint128)t * first.p + r1[i] + carry;
+                limbs[length - 1 - i] = (uint64_t)(value % BigInt::DEFAULT_MODULE);
+                carry = value / BigInt::DEFAULT_MODULE;
+            }
+            low.release(begin * sizeof(uint64_t), (end - begin) * sizeof(uint64_t));
+            high.release(begin * sizeof(uint64_t), (end - begin) * sizeof(uint64_t));
+            out.release(header_size + (length - end) * sizeof(uint64_t), (end - begin) * sizeof(uint64_t));
+        }
+        if (carry != 0)
+        {
+            throw std::exception();
+        }
+
+        // Старший разряд может оказаться нулём - сдвигаем разряды к заголовку и укорачиваем файл
+        size_t zeros = 0;
+        while (zeros + 1 < length && limbs[zeros] == 0)
+        {
+            zeros++;
+        }
+        if (zeros != 0)
+        {
+            std::memmove(limbs, limbs + zeros, (length - zeros) * sizeof(uint64_t));
+        }
+        const BigIntFile::Header header = BigIntFile::make_header(negative, length - zeros);
+        std::memcpy(out.bytes(), &header, sizeof(header));
+        out.truncate(header_size + (length - zeros) * sizeof(uint64_t));
+    }
+
+    Options _options;
+};
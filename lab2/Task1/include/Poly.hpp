@@ -0,0 +1,630 @@
+#pragma once
+#include "BigInt.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Многочлен с коэффициентами BigInt над Z (modulus == 0) или над Z/m (modulus = m > 1).
+// Коэффициенты хранятся младшим первым, без старших нулей; нулевой многочлен - пустой вектор.
+// Умножение - подстановкой Кронекера через быстрое умножение BigInt, а при m < 2^31 - через
+// NTT по трём простым с восстановлением по КТО. Деление и обратный ряд - по Ньютону,
+// вычисление во многих точках и интерполяция - по дереву подпроизведений.
+// Деление требует обратимого старшего коэффициента делителя (над Z - это +-1),
+// интерполяция - поля, т.е. простого модуля
+class Poly
+{
+public:
+    Poly() = default;
+
+    explicit Poly(std::vector<BigInt> coefficients, const BigInt &modulus = BigInt(0)) : _modulus(modulus), _coeffs(std::move(coefficients))
+    {
+        if (_modulus.sign() < 0 || _modulus == BigInt(1))
+        {
+            throw std::exception();
+        }
+        for (BigInt &c : _coeffs)
+        {
+            c = reduce(c);
+        }
+        trim();
+    }
+
+    const BigInt &modulus() const
+    {
+        return _modulus;
+    }
+
+    const std::vector<BigInt> &coefficients() const
+    {
+        return _coeffs;
+    }
+
+    // Степень, у нулевого многочлена - -1
+    long long degree() const
+    {
+        return (long long)_coeffs.size() - 1;
+    }
+
+    bool is_zero() const
+    {
+        return _coeffs.empty();
+    }
+
+    BigInt operator[](size_t i) const
+    {
+        return i < _coeffs.size() ? _coeffs[i] : BigInt(0);
+    }
+
+    bool operator==(const Poly &other) const
+    {
+        return _modulus == other._modulus && _coeffs == other._coeffs;
+    }
+
+    bool operator!=(const Poly &other) const
+    {
+        return !(*this == other);
+    }
+
+    Poly operator-() const
+    {
+        Poly result = *this;
+        for (BigInt &c : result._coeffs)
+        {
+            c = result.reduce(c * BigInt(-1));
+        }
+        return result;
+    }
+
+    Poly operator+(const Poly &other) const
+    {
+        check_same_ring(other);
+        Poly result = *this;
+        result._coeffs.resize(std::max(_coeffs.size(), other._coeffs.size()));
+        for (size_t i = 0; i < other._coeffs.size(); i++)
+        {
+            result._coeffs[i] = result.reduce(result._coeffs[i] + other._coeffs[i]);
+        }
+        result.trim();
+        return result;
+    }
+
+    Poly operator-(const Poly &other) const
+    {
+        return *this + (-other);
+    }
+
+    Poly operator*(const Poly &other) const
+    {
+        check_same_ring(other);
+        return with_coefficients(multiply(_coeffs, other._coeffs));
+    }
+
+    Poly operator/(const Poly &other) const
+    {
+        return divmod(other).first;
+    }
+
+    Poly operator%(const Poly &other) const
+    {
+        return divmod(other).second;
+    }
+
+    Poly &operator+=(const Poly &other)
+    {
+        return *this = *this + other;
+    }
+
+    Poly &operator-=(const Poly &other)
+    {
+        return *this = *this - other;
+    }
+
+    Poly &operator*=(const Poly &other)
+    {
+        return *this = *this * other;
+    }
+
+    // Значение в точке по схеме Горнера
+    BigInt evaluate(const BigInt &x) const
+    {
+        BigInt result = 0;
+        for (size_t i = _coeffs.size(); i-- > 0;)
+        {
+            result = reduce(result * x + _coeffs[i]);
+        }
+        return result;
+    }
+
+    Poly derivative() const
+    {
+        std::vector<BigInt> result;
+        for (size_t i = 1; i < _coeffs.size(); i++)
+        {
+            result.push_back(_coeffs[i] * BigInt((long long)i));
+        }
+        return Poly(std::move(result), _modulus);
+    }
+
+    // Многочлен g степени меньше n с f * g = 1 mod x^n; свободный член должен быть обратим.
+    // Итерация Ньютона g = g * (2 - f * g) удваивает число верных коэффициентов
+    Poly inverse(size_t n) const
+    {
+        if (_coeffs.empty())
+        {
+            throw std::exception();
+        }
+        std::vector<BigInt> g{unit_inverse(_coeffs[0])};
+        for (size_t k = 1; k < n;)
+        {
+            k = std::min(2 * k, n);
+            std::vector<BigInt> e = truncated(multiply(truncated(_coeffs, k), g), k);
+            for (BigInt &c : e)
+            {
+                c = reduce(c * BigInt(-1));
+            }
+            e.resize(std::max<size_t>(e.size(), 1));
+            e[0] = reduce(e[0] + BigInt(2));
+            g = truncated(multiply(g, e), k);
+        }
+        return with_coefficients(truncated(g, n));
+    }
+
+    // Частное и остаток; при длинном частном - через обратный ряд к перевёрнутому делителю
+    std::pair<Poly, Poly> divmod(const Poly &divisor) const
+    {
+        check_same_ring(divisor);
+        if (divisor.is_zero())
+        {
+            throw std::exception();
+        }
+        if (_coeffs.size() < divisor._coeffs.size())
+        {
+            return {with_coefficients({}), *this};
+        }
+        const size_t q_size = _coeffs.size() - divisor._coeffs.size() + 1;
+        if (q_size <= NEWTON_DIVISION_THRESHOLD || divisor._coeffs.size() <= NEWTON_DIVISION_THRESHOLD)
+        {
+            return long_division(divisor);
+        }
+
+        std::vector<BigInt> a_rev(_coeffs.rbegin(), _coeffs.rend()), b_rev(divisor._coeffs.rbegin(), divisor._coeffs.rend());
+        std::vector<BigInt> q = truncated(multiply(truncated(a_rev, q_size), Poly(b_rev, _modulus).inverse(q_size)._coeffs), q_size);
+        q.resize(q_size);
+        std::reverse(q.begin(), q.end());
+        Poly quotient = with_coefficients(std::move(q));
+        return {quotient, *this - quotient * divisor};
+    }
+
+    // Значения во всех точках спуском остатков по дереву подпроизведений
+    std::vector<BigInt> evaluate(const std::vector<BigInt> &points) const
+    {
+        std::vector<BigInt> values(points.size());
+        if (points.empty())
+        {
+            return values;
+        }
+        const SubproductTree tree = build_tree(points, _modulus);
+        evaluate_node(*this % tree.back().front(), tree, tree.size() - 1, 0, points, values);
+        return values;
+    }
+
+    // Многочлен степени меньше n, принимающий значения ys в попарно различных точках xs, над Z/modulus.
+    // f = sum c_i * M / (x - x_i), c_i = y_i / M'(x_i), сумма собирается подъёмом по дереву
+    static Poly interpolate(const std::vector<BigInt> &xs, const std::vector<BigInt> &ys, const BigInt &modulus)
+    {
+        if (xs.size() != ys.size() || modulus.sign() <= 0)
+        {
+            throw std::exception();
+        }
+        Poly zero({}, modulus);
+        if (xs.empty())
+        {
+            return zero;
+        }
+        const SubproductTree tree = build_tree(xs, modulus);
+        std::vector<BigInt> weights(xs.size());
+        Poly derivative = tree.back().front().derivative();
+        derivative.evaluate_node(derivative % tree.back().front(), tree, tree.size() - 1, 0, xs, weights);
+
+        std::vector<Poly> values;
+        for (size_t i = 0; i < xs.size(); i++)
+        {
+            values.push_back(Poly({ys[i] * weights[i].mod_inverse(modulus)}, modulus));
+        }
+        for (size_t level = 0; level + 1 < tree.size(); level++)
+        {
+            const std::vector<Poly> &nodes = tree[level];
+            std::vector<Poly> next((nodes.size() + 1) / 2);
+            for (size_t j = 0; j < next.size(); j++)
+            {
+                if (2 * j + 1 == nodes.size())
+                {
+                    next[j] = std::move(values[2 * j]);
+                    continue;
+                }
+                next[j] = values[2 * j] * nodes[2 * j + 1] + values[2 * j + 1] * nodes[2 * j];
+            }
+            values = std::move(next);
+        }
+        return values.front();
+    }
+
+private:
+    // Уровни дерева: на нулевом x - x_i, выше - произведения пар; непарный узел переходит наверх как есть
+    using SubproductTree = std::vector<std::vector<Poly>>;
+
+    static constexpr size_t SCHOOLBOOK_THRESHOLD = 8;
+    static constexpr size_t NEWTON_DIVISION_THRESHOLD = 32;
+    static constexpr size_t DIRECT_EVALUATION = 16;
+    static constexpr uint64_t NTT_PRIMES[3] = {998244353, 167772161, 469762049};
+    static constexpr size_t NTT_MAX_SIZE = size_t(1) << 23;
+
+    Poly with_coefficients(std::vector<BigInt> coefficients) const
+    {
+        Poly result;
+        result._modulus = _modulus;
+        result._coeffs = std::move(coefficients);
+        for (BigInt &c : result._coeffs)
+        {
+            c = result.reduce(c);
+        }
+        result.trim();
+        return result;
+    }
+
+    void trim()
+    {
+        while (!_coeffs.empty() && _coeffs.back().is_zero())
+        {
+            _coeffs.pop_back();
+        }
+    }
+
+    void check_same_ring(const Poly &other) const
+    {
+        if (_modulus != other._modulus)
+        {
+            throw std::exception();
+        }
+    }
+
+    // Над Z/m - остаток в [0, m), над Z - само число
+    BigInt reduce(const BigInt &x) const
+    {
+        if (_modulus.is_zero())
+        {
+            return x;
+        }
+        std::vector<unsigned long long> rem;
+        BigInt::divmod_magnitude(x.magnitude(), _modulus.magnitude(), rem);
+        if (x.is_negative() && !BigInt::is_zero_magnitude(rem))
+        {
+            rem = BigInt::sub_magnitude(_modulus.magnitude(), rem);
+        }
+        return BigInt::from_magnitude(std::move(rem), false);
+    }
+
+    BigInt unit_inverse(const BigInt &x) const
+    {
+        if (!_modulus.is_zero())
+        {
+            return x.mod_inverse(_modulus);
+        }
+        if (x != BigInt(1) && x != BigInt(-1))
+        {
+            throw std::exception();
+        }
+        return x;
+    }
+
+    static std::vector<BigInt> truncated(std::vector<BigInt> coeffs, size_t n)
+    {
+        if (coeffs.size() > n)
+        {
+            coeffs.resize(n);
+        }
+        return coeffs;
+    }
+
+    std::pair<Poly, Poly> long_division(const Poly &divisor) const
+    {
+        const size_t n = divisor._coeffs.size();
+        const BigInt lead_inverse = unit_inverse(divisor._coeffs.back());
+        std::vector<BigInt> rem = _coeffs, q(_coeffs.size() - n + 1);
+        for (size_t i = q.size(); i-- > 0;)
+        {
+            q[i] = reduce(rem[i + n - 1] * lead_inverse);
+            if (q[i].is_zero())
+            {
+                continue;
+            }
+            for (size_t j = 0; j < n; j++)
+            {
+                rem[i + j] = reduce(rem[i + j] - q[i] * divisor._coeffs[j]);
+            }
+        }
+        rem.resize(n - 1);
+        return {with_coefficients(std::move(q)), with_coefficients(std::move(rem))};
+    }
+
+    // Над Z/m коэффициенты произведения приведены в [0, m)
+    std::vector<BigInt> multiply(const std::vector<BigInt> &a, const std::vector<BigInt> &b) const
+    {
+        if (a.empty() || b.empty())
+        {
+            return {};
+        }
+        if (!_modulus.is_zero() && _modulus < BigInt(1LL << 31) && std::min(a.size(), b.size()) > SCHOOLBOOK_THRESHOLD && a.size() + b.size() - 1 <= NTT_MAX_SIZE)
+        {
+            return ntt_multiply(a, b);
+        }
+        std::vector<BigInt> result;
+        if (std::min(a.size(), b.size()) <= SCHOOLBOOK_THRESHOLD)
+        {
+            result.assign(a.size() + b.size() - 1, BigInt(0));
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                for (size_t j = 0; j < b.size(); j++)
+                {
+                    result[i + j] += a[i] * b[j];
+                }
+            }
+        }
+        else
+        {
+            result = kronecker_multiply(a, b);
+        }
+        for (BigInt &c : result)
+        {
+            c = reduce(c);
+        }
+        return result;
+    }
+
+    // Подстановка x = B = module^k: коэффициенты кладутся в число со слотами по k разрядов, и многочлены
+    // перемножаются одним умножением BigInt. Отрицательные коэффициенты дают второе число, которое вычитается,
+    // а на выходе слоты читаются в уравновешенной форме (-B/2, B/2). k с запасом вмещает n * max|a| * max|b|
+    static std::vector<BigInt> kronecker_multiply(const std::vector<BigInt> &a, const std::vector<BigInt> &b)
+    {
+        const size_t k = max_limbs(a) + max_limbs(b) + 1;
+        BigInt packed_a = pack(a, k), packed_b = pack(b, k);
+        const std::vector<unsigned long long> product = BigInt::fast_mul_magnitude(packed_a.magnitude(), packed_b.magnitude());
+        const bool negative = packed_a.is_negative() != packed_b.is_negative();
+
+        const std::vector<unsigned long long> slot_base = BigInt::shift_magnitude({1}, k);
+        const std::vector<unsigned long long> half = BigInt::shift_magnitude({BigInt::DEFAULT_MODULE / 2}, k - 1);
+        std::vector<BigInt> result(a.size() + b.size() - 1);
+        bool carry = false;
+        for (size_t i = 0; i < result.size(); i++)
+        {
+            // Слот i - разряды [i * k, (i + 1) * k) с младшего
+            const size_t end = product.size() > i * k ? product.size() - i * k : 0, begin = end > k ? end - k : 0;
+            std::vector<unsigned long long> slot(product.begin() + begin, product.begin() + end);
+            BigInt::trim_magnitude(slot);
+            if (carry)
+            {
+                slot = BigInt::add_magnitude(slot, {1});
+            }
+            carry = BigInt::compare_magnitude(slot, half) >= 0;
+            if (carry)
+            {
+                result[i] = BigInt::from_magnitude(BigInt::sub_magnitude(slot_base, slot), !negative);
+            }
+            else
+            {
+                result[i] = BigInt::from_magnitude(std::move(slot), negative);
+            }
+        }
+        return result;
+    }
+
+    static size_t max_limbs(const std::vector<BigInt> &coeffs)
+    {
+        size_t result = 1;
+        for (const BigInt &c : coeffs)
+        {
+            result = std::max(result, c.magnitude().size());
+        }
+        return result;
+    }
+
+    // sum c_i * module^(k i): положительные и отрицательные коэффициенты собираются отдельно
+    static BigInt pack(const std::vector<BigInt> &coeffs, size_t k)
+    {
+        std::vector<unsigned long long> positive(coeffs.size() * k, 0), negative;
+        for (size_t i = 0; i < coeffs.size(); i++)
+        {
+            const std::vector<unsigned long long> &mag = coeffs[i].magnitude();
+            if (coeffs[i].is_negative() && negative.empty())
+            {
+                negative.assign(coeffs.size() * k, 0);
+            }
+            std::vector<unsigned long long> &target = coeffs[i].is_negative() ? negative : positive;
+            std::copy(mag.rbegin(), mag.rend(), target.begin() + i * k);
+        }
+        auto to_bigint = [](std::vector<unsigned long long> le)
+        {
+            std::reverse(le.begin(), le.end());
+            BigInt::trim_magnitude(le);
+            return BigInt::from_magnitude(std::move(le), false);
+        };
+        return negative.empty() ? to_bigint(std::move(positive)) : to_bigint(std::move(positive)) - to_bigint(std::move(negative));
+    }
+
+    // Точная свёртка по трём простым NTT_PRIMES (их произведение больше n * m^2 при m < 2^31
+    // и n <= 2^23), затем Гарнер сразу по модулю m. Оценка верна только для коэффициентов из [0, m),
+    // поэтому входы сначала приводятся
+    std::vector<BigInt> ntt_multiply(const std::vector<BigInt> &a, const std::vector<BigInt> &b) const
+    {
+        const uint64_t m = to_word(_modulus);
+        auto words = [this](const std::vector<BigInt> &coeffs)
+        {
+            std::vector<uint64_t> result(coeffs.size());
+            for (size_t i = 0; i < coeffs.size(); i++)
+            {
+                result[i] = to_word(reduce(coeffs[i]));
+            }
+            return result;
+        };
+        const std::vector<uint64_t> a_words = words(a), b_words = words(b);
+        const size_t result_size = a.size() + b.size() - 1;
+        size_t size = 1;
+        while (size < result_size)
+        {
+            size <<= 1;
+        }
+
+        std::vector<uint64_t> residues[3];
+        for (size_t t = 0; t < 3; t++)
+        {
+            const uint64_t p = NTT_PRIMES[t];
+            std::vector<uint64_t> fa(size, 0), fb(size, 0);
+            for (size_t i = 0; i < a.size(); i++)
+            {
+                fa[i] = a_words[i] % p;
+            }
+            for (size_t i = 0; i < b.size(); i++)
+            {
+                fb[i] = b_words[i] % p;
+            }
+            ntt(fa, p, false);
+            ntt(fb, p, false);
+            for (size_t i = 0; i < size; i++)
+            {
+                fa[i] = fa[i] * fb[i] % p;
+            }
+            ntt(fa, p, true);
+            fa.resize(result_size);
+            residues[t] = std::move(fa);
+        }
+
+        const uint64_t p1 = NTT_PRIMES[0], p2 = NTT_PRIMES[1], p3 = NTT_PRIMES[2];
+        const uint64_t p1_inv = pow_mod(p1 % p2, p2 - 2, p2), p12_inv = pow_mod(p1 % p3 * (p2 % p3) % p3, p3 - 2, p3);
+        const uint64_t p1_mod_m = p1 % m, p12_mod_m = p1 % m * (p2 % m) % m;
+        std::vector<BigInt> result(result_size);
+        for (size_t i = 0; i < result_size; i++)
+        {
+            const uint64_t r1 = residues[0][i], r2 = residues[1][i], r3 = residues[2][i];
+            const uint64_t t2 = (r2 + p2 - r1 % p2) % p2 * p1_inv % p2;
+            const uint64_t x12 = r1 + p1 * t2;
+            const uint64_t t3 = (r3 + p3 - x12 % p3) % p3 * p12_inv % p3;
+            const uint64_t value = (r1 % m + p1_mod_m * t2 % m + p12_mod_m * t3 % m) % m;
+            result[i] = BigInt((long long)value);
+        }
+        return result;
+    }
+
+    static uint64_t to_word(const BigInt &x)
+    {
+        uint64_t result = 0;
+        for (unsigned long long limb : x.magnitude())
+        {
+            result = result * BigInt::DEFAULT_MODULE + limb;
+        }
+        return result;
+    }
+
+    static uint64_t pow_mod(uint64_t base, uint64_t exp, uint64_t p)
+    {
+        uint64_t result = 1;
+        base %= p;
+        while (exp > 0)
+        {
+            if (exp & 1)
+            {
+                result = result * base % p;
+            }
+            base = base * base % p;
+            exp >>= 1;
+        }
+        return result;
+    }
+
+    // Итеративное NTT по простому p = c * 2^k + 1 с первообразным корнем 3
+    static void ntt(std::vector<uint64_t> &a, uint64_t p, bool invert)
+    {
+        const size_t n = a.size();
+        for (size_t i = 1, j = 0; i < n; i++)
+        {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1)
+            {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j)
+            {
+                std::swap(a[i], a[j]);
+            }
+        }
+        for (size_t len = 2; len <= n; len <<= 1)
+        {
+            uint64_t root = pow_mod(3, (p - 1) / len, p);
+            if (invert)
+            {
+                root = pow_mod(root, p - 2, p);
+            }
+            for (size_t i = 0; i < n; i += len)
+            {
+                uint64_t w = 1;
+                for (size_t j = 0; j < len / 2; j++)
+                {
+                    const uint64_t u = a[i + j], v = a[i + j + len / 2] * w % p;
+                    a[i + j] = u + v < p ? u + v : u + v - p;
+                    a[i + j + len / 2] = u >= v ? u - v : u + p - v;
+                    w = w * root % p;
+                }
+            }
+        }
+        if (invert)
+        {
+            const uint64_t n_inv = pow_mod(n % p, p - 2, p);
+            for (uint64_t &x : a)
+            {
+                x = x * n_inv % p;
+            }
+        }
+    }
+
+    static SubproductTree build_tree(const std::vector<BigInt> &points, const BigInt &modulus)
+    {
+        SubproductTree tree(1);
+        for (const BigInt &x : points)
+        {
+            tree[0].push_back(Poly({x * BigInt(-1), BigInt(1)}, modulus));
+        }
+        while (tree.back().size() > 1)
+        {
+            const std::vector<Poly> &nodes = tree.back();
+            std::vector<Poly> next((nodes.size() + 1) / 2);
+            for (size_t j = 0; j < next.size(); j++)
+            {
+                next[j] = 2 * j + 1 == nodes.size() ? nodes[2 * j] : nodes[2 * j] * nodes[2 * j + 1];
+            }
+            tree.push_back(std::move(next));
+        }
+        return tree;
+    }
+
+    // rem = f mod (произведение узла j уровня level); узел покрывает точки [j * 2^level, (j + 1) * 2^level)
+    void evaluate_node(const Poly &rem, const SubproductTree &tree, size_t level, size_t j, const std::vector<BigInt> &points, std::vector<BigInt> &values) const
+    {
+        const size_t begin = j << level, end = std::min(points.size(), begin + (size_t(1) << level));
+        if (end - begin <= DIRECT_EVALUATION)
+        {
+            for (size_t i = begin; i < end; i++)
+            {
+                values[i] = rem.evaluate(points[i]);
+            }
+            return;
+        }
+        for (size_t child = 2 * j; child < std::min(2 * j + 2, tree[level - 1].size()); child++)
+        {
+            evaluate_node(rem % tree[level - 1][child], tree, level - 1, child, points, values);
+        }
+    }
+
+    BigInt _modulus = BigInt(0);
+    std::vector<BigInt> _coeffs;
+};
@@ -0,0 +1,256 @@
+#pragma once
+#include "BigInt.hpp"
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Числа Фибоначчи, Люка и степени матриц 2x2 удвоением индекса: O(M(n) log n) вместо n сложений.
+// На бит индекса Фибоначчи тратится два возведения в квадрат:
+// F(2k - 1) = F(k)^2 + F(k - 1)^2, F(2k + 1) = 4F(k)^2 - F(k - 1)^2 + 2(-1)^k, F(2k) = F(2k + 1) - F(2k - 1).
+// Варианты по модулю считают в форме Монтгомери, если модуль короткий и взаимно прост с module, иначе -
+// обычными вычетами с делением по Барретту
+class Recurrence
+{
+public:
+    // С этой длины модуля (в разрядах) квадратичное умножение Монтгомери медленнее Барретта
+    // с быстрым умножением
+    static constexpr size_t MONTGOMERY_MAX_LIMBS = 64;
+
+    // Матрица [[a, b], [c, d]]
+    struct Matrix2
+    {
+        BigInt a, b, c, d;
+    };
+
+    static BigInt fib(unsigned long long n)
+    {
+        return fib_pair(ExactRing(), index_words(n)).first;
+    }
+
+    // L(n) = F(n) + 2F(n - 1)
+    static BigInt lucas(unsigned long long n)
+    {
+        const ExactRing ring;
+        auto [f, g] = fib_pair(ring, index_words(n));
+        return ring.add(f, ring.add(g, g));
+    }
+
+    // F(n) mod m, n >= 0, m > 0
+    static BigInt fib(const BigInt &n, const BigInt &mod)
+    {
+        const std::vector<uint32_t> words = index_words(n);
+        return with_modulus<BigInt>(mod, [&words](const auto &ring, const auto &, const auto &lower)
+                            { return lower(fib_pair(ring, words).first); });
+    }
+
+    // L(n) mod m, n >= 0, m > 0
+    static BigInt lucas(const BigInt &n, const BigInt &mod)
+    {
+        const std::vector<uint32_t> words = index_words(n);
+        return with_modulus<BigInt>(mod, [&words](const auto &ring, const auto &, const auto &lower)
+                            {
+                                auto [f, g] = fib_pair(ring, words);
+                                return lower(ring.add(f, ring.add(g, g))); });
+    }
+
+    // m^exp, а при mod != 0 - m^exp mod |mod| с элементами из [0, |mod|)
+    static Matrix2 matrix_pow(const Matrix2 &m, const BigInt &exp, const BigInt &mod = BigInt(0))
+    {
+        const std::vector<uint32_t> words = index_words(exp);
+        if (mod.is_zero())
+        {
+            const ExactRing ring;
+            return unpack(matrix_pow(ring, pack(m, ring, identity), words), identity);
+        }
+        return with_modulus<Matrix2>(BigInt::from_magnitude(mod.magnitude(), false), [&m, &words](const auto &ring, const auto &lift, const auto &lower)
+                            { return unpack(matrix_pow(ring, pack(m, ring, lift), words), lower); });
+    }
+
+private:
+    // Целые числа без приведения, в том же интерфейсе, что и контексты по модулю
+    struct ExactRing
+    {
+        using Residue = BigInt;
+
+        BigInt one() const
+        {
+            return BigInt(1);
+        }
+
+        BigInt zero() const
+        {
+            return BigInt(0);
+        }
+
+        BigInt multiply(const BigInt &a, const BigInt &b) const
+        {
+            return a.karatsuba_multiply(b);
+        }
+
+        BigInt square(const BigInt &a) const
+        {
+            return a.square();
+        }
+
+        BigInt add(const BigInt &a, const BigInt &b) const
+        {
+            return a + b;
+        }
+
+        BigInt sub(const BigInt &a, const BigInt &b) const
+        {
+            return a - b;
+        }
+    };
+
+    template <typename Residue>
+    using ResidueMatrix = std::array<Residue, 4>;
+
+    static BigInt identity(const BigInt &x)
+    {
+        return x;
+    }
+
+    // Индекс - двоичные слова, младшее первым
+    static std::vector<uint32_t> index_words(unsigned long long n)
+    {
+        return {(uint32_t)n, (uint32_t)(n >> 32)};
+    }
+
+    static std::vector<uint32_t> index_words(const BigInt &n)
+    {
+        if (n.is_negative())
+        {
+            throw std::exception();
+        }
+        return BigInt::to_binary_words(n.magnitude());
+    }
+
+    static size_t bit_length(const std::vector<uint32_t> &words)
+    {
+        size_t bits = words.size() * 32;
+        while (bits > 0 && !bit(words, bits - 1))
+        {
+            --bits;
+        }
+        return bits;
+    }
+
+    static bool bit(const std::vector<uint32_t> &words, size_t i)
+    {
+        return (words[i / 32] >> (i % 32)) & 1;
+    }
+
+    // Вызывает body(ring, lift, lower) с контекстом приведения по модулю mod > 0
+    template <typename Result, typename Body>
+    static Result with_modulus(const BigInt &mod, const Body &body)
+    {
+        if (mod.is_negative() || mod.is_zero())
+        {
+            throw std::exception();
+        }
+        if (mod.magnitude().size() < MONTGOMERY_MAX_LIMBS && BigInt::MontgomeryContext::is_suitable(mod))
+        {
+            const BigInt::MontgomeryContext ring(mod);
+            return body(
+                ring, [&ring](const BigInt &x)
+                { return ring.to_montgomery(x); },
+                [&ring](const BigInt::MontgomeryContext::Residue &x)
+                { return ring.from_montgomery(x); });
+        }
+        const BigInt::BarrettContext ring(mod);
+        return body(
+            ring, [&ring](const BigInt &x)
+            { return ring.to_residue(x); },
+            [&ring](const BigInt::BarrettContext::Residue &x)
+            { return ring.from_residue(x); });
+    }
+
+    // Пара (F(n), F(n - 1)); F(-1) = 1
+    template <typename Ring>
+    static std::pair<typename Ring::Residue, typename Ring::Residue> fib_pair(const Ring &ring, const std::vector<uint32_t> &n)
+    {
+        using Residue = typename Ring::Residue;
+        const size_t bits = bit_length(n);
+        if (bits == 0)
+        {
+            return {ring.zero(), ring.one()};
+        }
+        const Residue two = ring.add(ring.one(), ring.one());
+        Residue f = ring.one(), g = ring.zero();
+        bool odd = true;
+        for (size_t i = bits - 1; i-- > 0;)
+        {
+            BigInt::progress_point((double)(bits - 1 - i) / (double)bits);
+            const Residue f2 = ring.square(f), g2 = ring.square(g);
+            const Residue f2_twice = ring.add(f2, f2);
+            Residue next = ring.sub(ring.add(f2_twice, f2_twice), g2);
+            next = odd ? ring.sub(next, two) : ring.add(next, two);
+            Residue prev = ring.add(f2, g2);
+            if (bit(n, i))
+            {
+                g = ring.sub(next, prev);
+                f = std::move(next);
+            }
+            else
+            {
+                f = ring.sub(next, prev);
+                g = std::move(prev);
+            }
+            odd = bit(n, i);
+        }
+        return {std::move(f), std::move(g)};
+    }
+
+    template <typename Ring, typename Lift>
+    static ResidueMatrix<typename Ring::Residue> pack(const Matrix2 &m, const Ring &, const Lift &lift)
+    {
+        return {lift(m.a), lift(m.b), lift(m.c), lift(m.d)};
+    }
+
+    template <typename Residue, typename Lower>
+    static Matrix2 unpack(const ResidueMatrix<Residue> &m, const Lower &lower)
+    {
+        return {lower(m[0]), lower(m[1]), lower(m[2]), lower(m[3])};
+    }
+
+    // [[a, b], [c, d]]^2 = [[a^2 + bc, b(a + d)], [c(a + d), d^2 + bc]]: два квадрата и три умножения
+    template <typename Ring>
+    static ResidueMatrix<typename Ring::Residue> matrix_square(const Ring &ring, const ResidueMatrix<typename Ring::Residue> &m)
+    {
+        const typename Ring::Residue bc = ring.multiply(m[1], m[2]), trace = ring.add(m[0], m[3]);
+        return {ring.add(ring.square(m[0]), bc), ring.multiply(m[1], trace), ring.multiply(m[2], trace), ring.add(ring.square(m[3]), bc)};
+    }
+
+    template <typename Ring>
+    static ResidueMatrix<typename Ring::Residue> matrix_multiply(const Ring &ring, const ResidueMatrix<typename Ring::Residue> &x, const ResidueMatrix<typename Ring::Residue> &y)
+    {
+        return {ring.add(ring.multiply(x[0], y[0]), ring.multiply(x[1], y[2])),
+                ring.add(ring.multiply(x[0], y[1]), ring.multiply(x[1], y[3])),
+                ring.add(ring.multiply(x[2], y[0]), ring.multiply(x[3], y[2])),
+                ring.add(ring.multiply(x[2], y[1]), ring.multiply(x[3], y[3]))};
+    }
+
+    // Возведение в степень слева направо
+    template <typename Ring>
+    static ResidueMatrix<typename Ring::Residue> matrix_pow(const Ring &ring, const ResidueMatrix<typename Ring::Residue> &m, const std::vector<uint32_t> &exp)
+    {
+        const size_t bits = bit_length(exp);
+        if (bits == 0)
+        {
+            return {ring.one(), ring.zero(), ring.zero(), ring.one()};
+        }
+        ResidueMatrix<typename Ring::Residue> result = m;
+        for (size_t i = bits - 1; i-- > 0;)
+        {
+            BigInt::progress_point((double)(bits - 1 - i) / (double)bits);
+            result = matrix_square(ring, result);
+            if (bit(exp, i))
+            {
+                result = matrix_multiply(ring, result, m);
+            }
+        }
+        return result;
+    }
+};
@@ -0,0 +1,408 @@
+#pragma once
+#include "BigInt.hpp"
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Система остаточных классов: набор попарно различных простых p_i < 2^31 и их произведение M.
+// Число x из (-M/2, M/2] хранится остатками x mod p_i
+class RnsBasis
+{
+public:
+    explicit RnsBasis(std::vector<uint32_t> primes) : _primes(std::move(primes))
+    {
+        if (_primes.empty())
+        {
+            throw std::exception();
+        }
+        for (size_t i = 0; i < _primes.size(); i++)
+        {
+            if (_primes[i] >= (1U << 31) || !is_small_prime(_primes[i]))
+            {
+                throw std::exception();
+            }
+            for (size_t j = 0; j < i; j++)
+            {
+                if (_primes[i] == _primes[j])
+                {
+                    throw std::exception();
+                }
+            }
+            _inv_primes.push_back(1.0 / (double)_primes[i]);
+        }
+
+        std::vector<unsigned long long> moduli(_primes.begin(), _primes.end());
+        _tree = build_tree(moduli);
+
+        // (M / p_i)^(-1) mod p_i; M / p_i mod p_i = (M mod p_i^2) / p_i
+        for (unsigned long long &m : moduli)
+        {
+            m *= m;
+        }
+        std::vector<unsigned long long> cofactors = remainders(modulus_magnitude(), build_tree(moduli));
+        for (size_t i = 0; i < _primes.size(); i++)
+        {
+            _crt_inverse.push_back((uint32_t)pow_mod(cofactors[i] / _primes[i], _primes[i] - 2, _primes[i]));
+        }
+    }
+
+    // Базис из наибольших простых меньше 2^31, вмещающий числа по модулю меньше 2^bits
+    static std::shared_ptr<const RnsBasis> for_bits(size_t bits)
+    {
+        std::vector<uint32_t> primes;
+        size_t covered = 0;
+        for (uint32_t candidate = (1U << 31) - 1; covered < bits + 2; candidate -= 2)
+        {
+            if (is_small_prime(candidate))
+            {
+                primes.push_back(candidate);
+                covered += 30;
+            }
+        }
+        return std::make_shared<const RnsBasis>(std::move(primes));
+    }
+
+    size_t size() const
+    {
+        return _primes.size();
+    }
+
+    const std::vector<uint32_t> &primes() const
+    {
+        return _primes;
+    }
+
+    const std::vector<double> &inverse_primes() const
+    {
+        return _inv_primes;
+    }
+
+    BigInt modulus() const
+    {
+        return BigInt::from_magnitude(modulus_magnitude(), false);
+    }
+
+    // Остатки x по всем модулям спуском по дереву остатков
+    std::vector<uint32_t> reduce(const BigInt &x) const
+    {
+        std::vector<unsigned long long> rem = remainders(x.magnitude(), _tree);
+        std::vector<uint32_t> result(rem.size());
+        for (size_t i = 0; i < rem.size(); i++)
+        {
+            result[i] = (uint32_t)(x.is_negative() && rem[i] != 0 ? _primes[i] - rem[i] : rem[i]);
+        }
+        return result;
+    }
+
+    // Китайская теорема об остатках подъёмом по дереву произведений:
+    // x = sum c_i * M / p_i, c_i = r_i * (M / p_i)^(-1) mod p_i
+    BigInt reconstruct(const std::vector<uint32_t> &residues) const
+    {
+        std::vector<std::vector<unsigned long long>> values(residues.size());
+        for (size_t i = 0; i < residues.size(); i++)
+        {
+            values[i] = BigInt::small_magnitude((unsigned long long)residues[i] * _crt_inverse[i] % _primes[i]);
+        }
+        for (size_t level = 0; level + 1 < _tree.size(); level++)
+        {
+            const std::vector<Node> &nodes = _tree[level];
+            std::vector<std::vector<unsigned long long>> next((nodes.size() + 1) / 2);
+            for (size_t j = 0; j < next.size(); j++)
+            {
+                if (2 * j + 1 == nodes.size())
+                {
+                    next[j] = std::move(values[2 * j]);
+                    continue;
+                }
+                next[j] = BigInt::add_magnitude(BigInt::fast_mul_magnitude(values[2 * j], nodes[2 * j + 1].value),
+                                                BigInt::fast_mul_magnitude(values[2 * j + 1], nodes[2 * j].value));
+            }
+            values = std::move(next);
+        }
+
+        const Node &root = _tree.back().front();
+        std::vector<unsigned long long> rem;
+        BigInt::barrett_divmod(values.front(), root.value, root.inverse, rem);
+        std::vector<unsigned long long> twice = BigInt::add_magnitude(rem, rem);
+        if (BigInt::compare_magnitude(twice, root.value) > 0)
+        {
+            return BigInt::from_magnitude(BigInt::sub_magnitude(root.value, rem), true);
+        }
+        return BigInt::from_magnitude(std::move(rem), false);
+    }
+
+private:
+    // Узел дерева произведений с заранее посчитанным обратным для деления по Барретту
+    struct Node
+    {
+        std::vector<unsigned long long> value, inverse;
+    };
+    using Tree = std::vector<std::vector<Node>>;
+
+    static Tree build_tree(const std::vector<unsigned long long> &moduli)
+    {
+        Tree tree(1);
+        for (unsigned long long m : moduli)
+        {
+            tree[0].push_back({BigInt::small_magnitude(m), {}});
+        }
+        while (tree.back().size() > 1)
+        {
+            const std::vector<Node> &below = tree.back();
+            std::vector<Node> level((below.size() + 1) / 2);
+            for (size_t j = 0; j < level.size(); j++)
+            {
+                level[j].value = 2 * j + 1 == below.size() ? below[2 * j].value : BigInt::fast_mul_magnitude(below[2 * j].value, below[2 * j + 1].value);
+                level[j].inverse = BigInt::barrett_inverse(level[j].value);
+            }
+            tree.push_back(std::move(level));
+        }
+        return tree;
+    }
+
+    static std::vector<unsigned long long> remainders(const std::vector<unsigned long long> &x, const Tree &tree)
+    {
+        std::vector<std::vector<unsigned long long>> current(1);
+        const Node &root = tree.back().front();
+        BigInt::divmod_magnitude(x, root.value, current[0]);
+        for (size_t level = tree.size() - 1; level-- > 0;)
+        {
+            std::vector<std::vector<unsigned long long>> next(tree[level].size());
+            for (size_t j = 0; j < next.size(); j++)
+            {
+                const Node &node = tree[level][j];
+                BigInt::barrett_divmod(current[j / 2], node.value, node.inverse, next[j]);
+            }
+            current = std::move(next);
+        }
+        std::vector<unsigned long long> result(current.size());
+        for (size_t i = 0; i < current.size(); i++)
+        {
+            for (unsigned long long limb : current[i])
+            {
+                result[i] = result[i] * BigInt::DEFAULT_MODULE + limb;
+            }
+        }
+        return result;
+    }
+
+    std::vector<unsigned long long> modulus_magnitude() const
+    {
+        return _tree.back().front().value;
+    }
+
+    // Проверка делением на простые до sqrt(2^31)
+    static bool is_small_prime(uint32_t n)
+    {
+        static const std::vector<uint32_t> divisors = []()
+        {
+            const uint32_t limit = 46341;
+            std::vector<bool> composite(limit + 1, false);
+            std::vector<uint32_t> primes;
+            for (uint32_t i = 2; i <= limit; i++)
+            {
+                if (!composite[i])
+                {
+                    primes.push_back(i);
+                    for (unsigned long long j = (unsigned long long)i * i; j <= limit; j += i)
+                    {
+                        composite[j] = true;
+                    }
+                }
+            }
+            return primes;
+        }();
+        if (n < 2)
+        {
+            return false;
+        }
+        for (uint32_t d : divisors)
+        {
+            if ((unsigned long long)d * d > n)
+            {
+                break;
+            }
+            if (n % d == 0)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static unsigned long long pow_mod(unsigned long long base, unsigned long long exp, unsigned long long mod)
+    {
+        unsigned long long result = 1;
+        base %= mod;
+        for (; exp != 0; exp >>= 1)
+        {
+            if (exp & 1)
+            {
+                result = result * base % mod;
+            }
+            base = base * base % mod;
+        }
+        return result;
+    }
+
+    std::vector<uint32_t> _primes;
+    std::vector<double> _inv_primes;
+    std::vector<uint32_t> _crt_inverse;
+    Tree _tree;
+};
+
+// Число в системе остаточных классов: сложение, вычитание и умножение независимы по модулям,
+// ядра - простые циклы без ветвлений, длинные векторы делятся между потоками
+class RnsBigInt
+{
+public:
+    // Начиная с этого числа модулей поразрядные операции раздаются потокам
+    static constexpr size_t PARALLEL_THRESHOLD = 1 << 16;
+
+    explicit RnsBigInt(std::shared_ptr<const RnsBasis> basis) : _basis(std::move(basis)), _residues(_basis->size(), 0)
+    {
+    }
+
+    RnsBigInt(std::shared_ptr<const RnsBasis> basis, const BigInt &value) : _basis(std::move(basis)), _residues(_basis->reduce(value))
+    {
+    }
+
+    BigInt to_bigint() const
+    {
+        return _basis->reconstruct(_residues);
+    }
+
+    const std::vector<uint32_t> &residues() const
+    {
+        return _residues;
+    }
+
+    const std::shared_ptr<const RnsBasis> &basis() const
+    {
+        return _basis;
+    }
+
+    RnsBigInt &operator+=(const RnsBigInt &other)
+    {
+        check_basis(other);
+        run(add_kernel, other);
+        return *this;
+    }
+
+    RnsBigInt &operator-=(const RnsBigInt &other)
+    {
+        check_basis(other);
+        run(sub_kernel, other);
+        return *this;
+    }
+
+    RnsBigInt &operator*=(const RnsBigInt &other)
+    {
+        check_basis(other);
+        run(mul_kernel, other);
+        return *this;
+    }
+
+    RnsBigInt operator+(const RnsBigInt &other) const
+    {
+        RnsBigInt result = *this;
+        return result += other;
+    }
+
+    RnsBigInt operator-(const RnsBigInt &other) const
+    {
+        RnsBigInt result = *this;
+        return result -= other;
+    }
+
+    RnsBigInt operator*(const RnsBigInt &other) const
+    {
+        RnsBigInt result = *this;
+        return result *= other;
+    }
+
+    RnsBigInt operator-() const
+    {
+        return RnsBigInt(_basis) - *this;
+    }
+
+    bool operator==(const RnsBigInt &other) const
+    {
+        return _basis == other._basis && _residues == other._residues;
+    }
+
+    // a[i] = (a[i] + b[i]) mod p[i]
+    static void add_kernel(uint32_t *a, const uint32_t *b, const uint32_t *p, const double *, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t sum = a[i] + b[i];
+            a[i] = sum >= p[i] ? sum - p[i] : sum;
+        }
+    }
+
+    static void sub_kernel(uint32_t *a, const uint32_t *b, const uint32_t *p, const double *, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            uint32_t diff = a[i] - b[i];
+            a[i] = a[i] < b[i] ? diff + p[i] : diff;
+        }
+    }
+
+    // Частное a * b / p оценивается в double (ошибка не больше единицы при p < 2^31),
+    // остаток досчитывается в целых без деления
+    static void mul_kernel(uint32_t *a, const uint32_t *b, const uint32_t *p, const double *inv_p, size_t n)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            const unsigned long long product = (unsigned long long)a[i] * b[i];
+            const long long q = (long long)((double)a[i] * (double)b[i] * inv_p[i]);
+            long long r = (long long)(product - (unsigned long long)q * p[i]);
+            r += r < 0 ? p[i] : 0;
+            r -= r >= p[i] ? p[i] : 0;
+            a[i] = (uint32_t)r;
+        }
+    }
+
+private:
+    using Kernel = void (*)(uint32_t *, const uint32_t *, const uint32_t *, const double *, size_t);
+
+    void check_basis(const RnsBigInt &other) const
+    {
+        if (_basis != other._basis)
+        {
+            throw std::exception();
+        }
+    }
+
+    void run(Kernel kernel, const RnsBigInt &other)
+    {
+        const size_t n = _residues.size();
+        uint32_t *a = _residues.data();
+        const uint32_t *b = other._residues.data(), *p = _basis->primes().data();
+        const double *inv = _basis->inverse_primes().data();
+        if (n < PARALLEL_THRESHOLD)
+        {
+            kernel(a, b, p, inv, n);
+            return;
+        }
+        const size_t parts = std::max(1u, std::thread::hardware_concurrency());
+        const size_t chunk = (n + parts - 1) / parts;
+        std::vector<std::future<void>> tasks;
+        for (size_t begin = 0; begin < n; begin += chunk)
+        {
+            const size_t len = std::min(chunk, n - begin);
+            tasks.push_back(std::async(std::launch::async, kernel, a + begin, b + begin, p + begin, inv + begin, len));
+        }
+        for (std::future<void> &task : tasks)
+        {
+            task.get();
+        }
+    }
+
+    std::shared_ptr<const RnsBasis> _basis;
+    std::vector<uint32_t> _residues;
+};
@@ -1,5 +1,23 @@
 #include "BigInt.hpp"
+#include "BinarySplitting.hpp"
+#include "FixedBigInt.hpp"
+#include "BigIntFile.hpp"
+#include "RnsBigInt.hpp"
+#include "FixedBaseExponentiator.hpp"
+#include "Poly.hpp"
+#include "OutOfCoreMultiplier.hpp"
+#include "Recurrence.hpp"
 #include <gtest/gtest.h>
+#include <unordered_map>
+#include <limits>
+#include <sstream>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+#ifdef BIGINT_TELEMETRY
+BIGINT_TELEMETRY_ALLOCATION_HOOKS
+#endif
 
 class BigIntTest : public ::testing::Test
 {
@@ -314,6 +332,846 @@ TEST_F(BigIntTest, ModularExponentiationWithModWorks) {
     EXPECT_EQ(BigInt::BigInt_mod_exp(BigInt(2), BigInt(10), BigInt(1000)), BigInt(24));
 }
 
+TEST_F(BigIntTest, BinarySplittingComputesPartialSumOfE) {
+    auto p = [](unsigned long long) { return BigInt(1); };
+    auto q = [](unsigned long long k) { return BigInt(k == 0 ? 1 : (long long)k); };
+    auto a = [](unsigned long long) { return BigInt(1); };
+    auto [T, Q] = binary_splitting(p, q, a, 20);
+    EXPECT_EQ(Q, BigInt("121645100408832000"));
+    EXPECT_EQ(T, BigInt("330665665962404000"));
+}
+
+TEST_F(BigIntTest, BinarySplittingParallelMatchesSequential) {
+    auto p = [](unsigned long long k) { return BigInt(-(long long)(2 * k + 1)); };
+    auto q = [](unsigned long long k) { return BigInt((long long)(3 * k + 2)); };
+    auto a = [](unsigned long long k) { return BigInt((long long)(k + 1)); };
+    auto sequential = binary_splitting(p, q, a, 57);
+    auto parallel = binary_splitting(p, q, a, 57, 3);
+    EXPECT_EQ(sequential.first, parallel.first);
+    EXPECT_EQ(sequential.second, parallel.second);
+}
+
+static BigInt fibonacci_by_addition(int n) {
+    BigInt a(0), b(1);
+    for (int i = 0; i < n; i++) {
+        BigInt t = a + b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+TEST_F(BigIntTest, GcdOfSmallNumbers) {
+    EXPECT_EQ(BigInt::gcd(BigInt(462), BigInt(-1071)), BigInt(21));
+    EXPECT_EQ(BigInt::gcd(zero, BigInt(-5)), BigInt(5));
+    EXPECT_EQ(BigInt::gcd(zero, zero), zero);
+}
+
+TEST_F(BigIntTest, GcdOfLargeFibonacciNumbers) {
+    // gcd(F(m), F(n)) = F(gcd(m, n)), все частные Евклида равны 1
+    BigInt a = fibonacci_by_addition(4000), b = fibonacci_by_addition(3600);
+    EXPECT_EQ(BigInt::gcd(a, b), fibonacci_by_addition(400));
+    EXPECT_EQ(BigInt::gcd(b * bigNum5, a * bigNum5), fibonacci_by_addition(400) * bigNum5);
+}
+
+TEST_F(BigIntTest, ExtendedGcdGivesBezoutCoefficients) {
+    BigInt a = fibonacci_by_addition(3001) * bigNum1, b = fibonacci_by_addition(2000) * bigNum1, x, y;
+    BigInt g = BigInt::xgcd(a, b, x, y);
+    EXPECT_EQ(g, BigInt::gcd(a, b));
+    EXPECT_EQ(a * x + b * y, g);
+
+    BigInt small_g = BigInt::xgcd(BigInt(-240), BigInt(46), x, y);
+    EXPECT_EQ(small_g, BigInt(2));
+    EXPECT_EQ(BigInt(-240) * x + BigInt(46) * y, BigInt(2));
+}
+
+TEST_F(BigIntTest, ModInverseWorks) {
+    EXPECT_EQ(BigInt(3).mod_inverse(BigInt(10)), BigInt(7));
+    EXPECT_EQ(BigInt(-3).mod_inverse(BigInt(10)), BigInt(3));
+    EXPECT_THROW(BigInt(4).mod_inverse(BigInt(10)), std::exception);
+
+    BigInt m = fibonacci_by_addition(2001), a = fibonacci_by_addition(1500) + BigInt(7);
+    BigInt inv = a.mod_inverse(m);
+    EXPECT_TRUE(inv < m);
+    EXPECT_EQ(BigInt::gcd(a * inv - BigInt(1), m), m);
+}
+
+TEST_F(BigIntTest, IsqrtOfSmallNumbers) {
+    EXPECT_EQ(zero.isqrt(), zero);
+    EXPECT_EQ(BigInt(1).isqrt(), BigInt(1));
+    EXPECT_EQ(BigInt(99).isqrt(), BigInt(9));
+    EXPECT_EQ(BigInt(100).isqrt(), BigInt(10));
+    EXPECT_THROW(neg456.isqrt(), std::exception);
+}
+
+TEST_F(BigIntTest, IsqrtOfLargeNumbers) {
+    BigInt root = bigNum5 * bigNum6 + bigNum1;
+    BigInt square = root * root;
+    EXPECT_EQ(square.isqrt(), root);
+    EXPECT_EQ((square - BigInt(1)).isqrt(), root - BigInt(1));
+    EXPECT_EQ((square + root + root).isqrt(), root);
+}
+
+TEST_F(BigIntTest, IrootWorks) {
+    EXPECT_EQ(BigInt(1000).iroot(3), BigInt(10));
+    EXPECT_EQ(BigInt(999).iroot(3), BigInt(9));
+    EXPECT_EQ(BigInt(-27).iroot(3), BigInt(-3));
+    EXPECT_EQ(bigNum1.iroot(500), BigInt(1));
+
+    BigInt root = bigNum2 + BigInt(12345);
+    BigInt cube = root * root * root;
+    EXPECT_EQ(cube.iroot(3), root);
+    EXPECT_EQ((cube - BigInt(1)).iroot(3), root - BigInt(1));
+    EXPECT_EQ((cube * root * root).iroot(5), root);
+}
+
+TEST_F(BigIntTest, IsPerfectSquareWorks) {
+    EXPECT_TRUE(zero.is_perfect_square());
+    EXPECT_TRUE(BigInt(144).is_perfect_square());
+    EXPECT_FALSE(BigInt(145).is_perfect_square());
+    EXPECT_FALSE(BigInt(-4).is_perfect_square());
+    EXPECT_TRUE((bigNum5 * bigNum5).is_perfect_square());
+    EXPECT_FALSE((bigNum5 * bigNum5 + BigInt(1)).is_perfect_square());
+    EXPECT_FALSE((bigNum5 * bigNum6).is_perfect_square());
+}
+
+TEST_F(BigIntTest, ModularExponentiationWithLargeOddModWorks) {
+    BigInt mod("170141183460469231731687303715884105727");
+    EXPECT_EQ(BigInt::BigInt_mod_exp(bigNum1, BigInt(5), mod), (bigNum1 * bigNum1 * bigNum1 * bigNum1 * bigNum1) % mod);
+    EXPECT_EQ(bigNum2.mod_exp(mod - BigInt(1), mod), BigInt(1));
+}
+
+TEST_F(BigIntTest, MontgomeryContextRoundTrip) {
+    BigInt mod = bigNum5 + BigInt(1);
+    BigInt::MontgomeryContext ctx(mod);
+    auto a = ctx.to_montgomery(bigNum1), b = ctx.to_montgomery(bigNum2);
+    EXPECT_EQ(ctx.from_montgomery(a), bigNum1);
+    EXPECT_EQ(ctx.from_montgomery(ctx.multiply(a, b)), (bigNum1 * bigNum2) % mod);
+    EXPECT_EQ(ctx.from_montgomery(ctx.to_montgomery(BigInt(-3))), mod - BigInt(3));
+    EXPECT_THROW(BigInt::MontgomeryContext(BigInt(1000)), std::exception);
+}
+
+TEST_F(BigIntTest, IsProbablePrimeOnSmallNumbers) {
+    EXPECT_FALSE(zero.is_probable_prime());
+    EXPECT_FALSE(BigInt(1).is_probable_prime());
+    EXPECT_TRUE(BigInt(2).is_probable_prime());
+    EXPECT_TRUE(BigInt(1999).is_probable_prime());
+    EXPECT_FALSE(BigInt(561).is_probable_prime());
+    EXPECT_FALSE(BigInt(-7).is_probable_prime());
+}
+
+TEST_F(BigIntTest, IsProbablePrimeOnLargeNumbers) {
+    BigInt mersenne127("170141183460469231731687303715884105727");
+    BigInt mersenne89("618970019642690137449562111");
+    EXPECT_TRUE(mersenne127.is_probable_prime(5));
+    EXPECT_TRUE(mersenne89.is_probable_prime());
+    EXPECT_FALSE((mersenne127 * mersenne89).is_probable_prime());
+    // квадраты простых, больших границы пробного деления
+    EXPECT_FALSE(BigInt(1194649).is_probable_prime());
+    EXPECT_FALSE(BigInt(12327121).is_probable_prime());
+    // сильное псевдопростое по основанию 2
+    EXPECT_FALSE(BigInt("3825123056546413051").is_probable_prime());
+}
+
+TEST_F(BigIntTest, NextPrimeWorks) {
+    EXPECT_EQ(zero.next_prime(), BigInt(2));
+    EXPECT_EQ(BigInt(13).next_prime(), BigInt(17));
+    EXPECT_EQ(BigInt(1999).next_prime(), BigInt(2003));
+    EXPECT_EQ(BigInt("100000000000000000000").next_prime(), BigInt("100000000000000000039"));
+}
+
+TEST_F(BigIntTest, FixedBigIntConvertsToAndFromBigInt) {
+    FixedBigInt<256> a(bigNum1);
+    EXPECT_EQ(a.to_bigint(), bigNum1);
+    EXPECT_EQ(BigInt(FixedBigInt<512>(bigNum5)), bigNum5);
+    EXPECT_EQ(FixedBigInt<256>("1234567890123456789012345678901234567890"), a);
+    EXPECT_EQ(FixedBigInt<128>(-1), ~FixedBigInt<128>(0));
+    EXPECT_EQ(BigInt(FixedBigInt<128>(-1)), BigInt("340282366920938463463374607431768211455"));
+}
+
+TEST_F(BigIntTest, FixedBigIntArithmeticMatchesBigInt) {
+    FixedBigInt<512> a(bigNum5), b(bigNum6), c(bigNum1);
+    EXPECT_EQ(BigInt(a + b), bigNum5 + bigNum6);
+    EXPECT_EQ(BigInt(b - a), bigNum6 - bigNum5);
+    EXPECT_EQ(BigInt(a * b), bigNum5 * bigNum6);
+    EXPECT_EQ(BigInt(a * b / c), (bigNum5 * bigNum6) / bigNum1);
+    EXPECT_EQ(BigInt(a * b % c), (bigNum5 * bigNum6) % bigNum1);
+    EXPECT_EQ(BigInt(a / FixedBigInt<512>(1000)), bigNum5 / BigInt(1000));
+    EXPECT_TRUE(a < b);
+    EXPECT_TRUE(b >= a);
+    EXPECT_EQ(BigInt(a << 3), bigNum5 * BigInt(8));
+    EXPECT_EQ(BigInt((a << 100) >> 100), bigNum5);
+}
+
+TEST_F(BigIntTest, FixedBigIntWrapsAround) {
+    FixedBigInt<256> max = ~FixedBigInt<256>(0);
+    EXPECT_TRUE((max + FixedBigInt<256>(1)).is_zero());
+    EXPECT_EQ(FixedBigInt<256>(0) - FixedBigInt<256>(1), max);
+    FixedBigInt<256> x = max;
+    ++x;
+    EXPECT_TRUE(x.is_zero());
+    --x;
+    EXPECT_EQ(x, max);
+    EXPECT_EQ(max.bit_length(), 256u);
+}
+
+TEST_F(BigIntTest, FixedBigIntModExp) {
+    FixedBigInt<256> mod("170141183460469231731687303715884105727");
+    FixedBigInt<256> base(bigNum1);
+    EXPECT_EQ(base.mod_exp(FixedBigInt<256>(5), mod).to_bigint(), BigInt::BigInt_mod_exp(bigNum1, BigInt(5), mod.to_bigint()));
+    EXPECT_EQ(base.mod_exp(mod - FixedBigInt<256>(1), mod), FixedBigInt<256>(1));
+
+    FixedBigInt<4096> big_base(bigNum6), big_mod(bigNum5 * bigNum5 + BigInt(1));
+    EXPECT_EQ(big_base.mod_exp(FixedBigInt<4096>(3), big_mod).to_bigint(), (bigNum6 * bigNum6 * bigNum6) % (bigNum5 * bigNum5 + BigInt(1)));
+
+    BigInt wide_exp = BigInt(3).mod_exp(BigInt(500)) + BigInt(11);
+    for (const BigInt &m : {bigNum5 * bigNum5 + BigInt(1), (bigNum5 * bigNum5 + BigInt(1)) * BigInt(1024), BigInt(2).mod_exp(BigInt(700)), BigInt(1)}) {
+        EXPECT_EQ(FixedBigInt<1024>(bigNum6).mod_exp(FixedBigInt<1024>(wide_exp), FixedBigInt<1024>(m)).to_bigint(), bigNum6.mod_exp(wide_exp, m));
+    }
+    EXPECT_EQ(base.mod_exp(FixedBigInt<256>(12345), FixedBigInt<256>(1000)).to_bigint(), BigInt::BigInt_mod_exp(bigNum1, BigInt(12345), BigInt(1000)));
+}
+
+TEST_F(BigIntTest, BigLiteralIsParsedAtCompileTime) {
+    constexpr auto mersenne = 170141183460469231731687303715884105727_big;
+    static_assert(decltype(mersenne)::LIMBS == 3);
+    static_assert(mersenne == (FixedBigInt<192>(1) << 127) - FixedBigInt<192>(1));
+    static_assert(0xFFFF'FFFF'FFFF'FFFF'FFFF_big == (FixedBigInt<128>(1) << 80) - FixedBigInt<128>(1));
+    static_assert(0b1010_big == FixedBigInt<64>(10));
+    static_assert(017_big == FixedBigInt<64>(15));
+    static_assert(18446744073709551616_big == FixedBigInt<128>(1) << 64);
+    EXPECT_EQ(mersenne.to_bigint(), BigInt("170141183460469231731687303715884105727"));
+}
+
+TEST_F(BigIntTest, FixedBigIntArithmeticIsConstexpr) {
+    constexpr FixedBigInt<256> a = 123456789012345678901234567890_big, b = 987654321_big;
+    constexpr FixedBigInt<256> product = a * b, quotient = product / b;
+    static_assert(quotient == a);
+    static_assert(product % b == FixedBigInt<256>(0));
+    static_assert(a.mod_exp(FixedBigInt<256>(3), b) == (a * a % b) * a % b);
+    EXPECT_EQ(BigInt(product), BigInt("123456789012345678901234567890") * BigInt(987654321));
+}
+
+TEST_F(BigIntTest, FixedMontgomeryParamsAreConstexpr) {
+    constexpr FixedBigInt<128> mod(170141183460469231731687303715884105727_big);
+    constexpr FixedMontgomeryParams<128> params(mod);
+    static_assert(params.from_montgomery(params.to_montgomery(FixedBigInt<128>(42))) == FixedBigInt<128>(42));
+    constexpr FixedBigInt<128> x = 98765432109876543210_big, y = 12345678901234567890_big;
+    constexpr auto product = params.from_montgomery(params.multiply(params.to_montgomery(x), params.to_montgomery(y)));
+    static_assert(product == FixedBigInt<128>(x.mul_wide(y) % FixedBigInt<256>(mod)));
+    EXPECT_EQ(BigInt(product), (BigInt("98765432109876543210") * BigInt("12345678901234567890")) % BigInt(mod));
+}
+
+TEST_F(BigIntTest, ThreeWayComparisonWorks) {
+    EXPECT_EQ(pos123 <=> neg456, std::strong_ordering::greater);
+    EXPECT_EQ(neg456 <=> BigInt(-455), std::strong_ordering::less);
+    EXPECT_EQ(bigNum3 <=> bigNum4, std::strong_ordering::less);
+    EXPECT_EQ(largeNeg <=> BigInt("-98765432109876543210"), std::strong_ordering::equal);
+    EXPECT_TRUE(largeNeg < neg456);
+    EXPECT_TRUE(bigNum4 > bigNum3);
+    EXPECT_TRUE(zero == BigInt(0) * BigInt(-1));
+    EXPECT_TRUE(BigInt() == zero);
+}
+
+TEST_F(BigIntTest, SortingUsesThreeWayComparison) {
+    std::vector<BigInt> values = {bigNum4, neg456, bigNum1, zero, largeNeg, pos123, bigNum3};
+    std::sort(values.begin(), values.end());
+    std::vector<BigInt> expected = {largeNeg, neg456, zero, pos123, bigNum1, bigNum3, bigNum4};
+    EXPECT_EQ(values, expected);
+}
+
+TEST_F(BigIntTest, BigIntCanBeHashTableKey) {
+    std::unordered_map<BigInt, int> table;
+    table[bigNum1] = 1;
+    table[neg456] = 2;
+    table[BigInt("1234567890123456789012345678901234567890")] += 10;
+    EXPECT_EQ(table.size(), 2u);
+    EXPECT_EQ(table[bigNum1], 11);
+    EXPECT_EQ(std::hash<BigInt>()(zero), std::hash<BigInt>()(BigInt(0) * BigInt(-1)));
+    EXPECT_NE(std::hash<BigInt>()(pos123), std::hash<BigInt>()(BigInt(-123)));
+}
+
+TEST_F(BigIntTest, ArithmeticWithNativeIntegers) {
+    EXPECT_EQ(BigInt("999999999999999999") + 1, BigInt("1000000000000000000"));
+    EXPECT_EQ(BigInt("1000000000000000000") - 1, BigInt("999999999999999999"));
+    EXPECT_EQ(pos123 - 500, BigInt(-377));
+    EXPECT_EQ(neg456 + 456, zero);
+    EXPECT_EQ(bigNum1 * -3, bigNum1 * BigInt(-3));
+    EXPECT_EQ(bigNum1 * 12345678901234ULL, bigNum1 * BigInt("12345678901234"));
+    EXPECT_EQ(bigNum1 / 7, bigNum1 / BigInt(7));
+    EXPECT_EQ(BigInt(-17) / 5, BigInt(-3));
+    EXPECT_EQ(BigInt(-17) % 5, BigInt(-2));
+    EXPECT_EQ(bigNum1 % 1000000007LL, bigNum1 % BigInt(1000000007));
+    EXPECT_EQ(BigInt("9223372036854775808") + std::numeric_limits<long long>::min(), zero);
+    EXPECT_THROW(pos123 / 0, std::exception);
+}
+
+TEST_F(BigIntTest, CompoundAssignmentWithNativeIntegers) {
+    BigInt num = bigNum3;
+    num *= 1000;
+    num += 7;
+    num -= 7;
+    num /= 1000;
+    EXPECT_EQ(num, bigNum3);
+    num %= 10;
+    EXPECT_EQ(num, BigInt(9));
+    ++num;
+    EXPECT_EQ(num, BigInt(10));
+}
+
+TEST_F(BigIntTest, ParityAndSignQueries) {
+    EXPECT_TRUE(zero.is_zero());
+    EXPECT_TRUE(zero.is_even());
+    EXPECT_TRUE(pos123.is_odd());
+    EXPECT_TRUE(neg456.is_even());
+    EXPECT_EQ(neg456.sign(), -1);
+    EXPECT_EQ(zero.sign(), 0);
+    EXPECT_EQ(bigNum1.sign(), 1);
+    EXPECT_EQ(zero << BigInt(5), zero);
+    EXPECT_EQ(BigInt(1) << BigInt(70), BigInt("1180591620717411303424"));
+    EXPECT_EQ(BigInt("-1180591620717411303425") >> BigInt(70), BigInt(-1));
+}
+
+TEST_F(BigIntTest, ExportImportBytesRoundTrip) {
+    std::vector<uint8_t> bytes = BigInt(0x0102030405LL).export_bytes();
+    EXPECT_EQ(bytes, (std::vector<uint8_t>{1, 2, 3, 4, 5}));
+    bytes = BigInt(0x0102030405LL).export_bytes(4, std::endian::little, std::endian::little);
+    EXPECT_EQ(bytes, (std::vector<uint8_t>{5, 4, 3, 2, 1, 0, 0, 0}));
+    EXPECT_EQ(BigInt::import_bytes(bytes, 4, std::endian::little, std::endian::little), BigInt(0x0102030405LL));
+    EXPECT_TRUE(zero.export_bytes().empty());
+    EXPECT_EQ(BigInt::import_bytes(bigNum4.export_bytes(8, std::endian::big, std::endian::big), 8, std::endian::big, std::endian::big), bigNum4);
+    EXPECT_EQ(BigInt::import_bytes(largeNeg.export_bytes(), 1, std::endian::big, std::endian::native, true), largeNeg);
+    EXPECT_THROW(BigInt::import_bytes(bytes, 3), std::exception);
+}
+
+TEST_F(BigIntTest, RawLimbFileRoundTrip) {
+    const std::string path = ::testing::TempDir() + "bigint_raw_limbs.bin";
+    BigInt value = BigInt("-123456789012345678901234567890") * bigNum4;
+    BigIntFile::save(path, value);
+    EXPECT_EQ(BigIntFile::load(path), value);
+
+    MappedBigInt mapped(path);
+    EXPECT_TRUE(mapped.is_negative());
+    ASSERT_EQ(mapped.limbs().size(), 8u);
+    EXPECT_EQ(mapped.limbs().front(), 1234567u);
+    EXPECT_EQ(mapped.limbs().back(), 0u);
+    EXPECT_EQ(mapped.to_bigint(), value);
+
+    std::stringstream corrupted;
+    BigIntFile::write(corrupted, value);
+    std::string raw = corrupted.str();
+    raw[0] = 'X';
+    std::stringstream broken(raw);
+    EXPECT_THROW(BigIntFile::read(broken), std::exception);
+    std::remove(path.c_str());
+}
+
+TEST_F(BigIntTest, ToStringInArbitraryBase) {
+    EXPECT_EQ(BigInt(255).to_string(16), "ff");
+    EXPECT_EQ(BigInt(-255).to_string(2), "-11111111");
+    EXPECT_EQ(zero.to_string(36), "0");
+    for (unsigned base : {2u, 10u, 16u, 36u}) {
+        EXPECT_EQ(BigInt().to_string(base), "0");
+    }
+    EXPECT_EQ(bigNum1.to_string(10), "1234567890123456789012345678901234567890");
+    EXPECT_EQ(bigNum4.to_string(16), "1d6329f1c35ca4bfabb9f5610000000000");
+    EXPECT_EQ(BigInt("1000000000000").to_string(7), "132150634516021");
+    EXPECT_THROW(pos123.to_string(37), std::exception);
+}
+
+TEST_F(BigIntTest, FromStringInArbitraryBase) {
+    EXPECT_EQ(BigInt::from_string("FF", 16), BigInt(255));
+    EXPECT_EQ(BigInt::from_string("-zz", 36), BigInt(-1295));
+    EXPECT_EQ(BigInt::from_string("1d6329f1c35ca4bfabb9f5610000000000", 16), bigNum4);
+    EXPECT_THROW(BigInt::from_string("12a", 10), std::exception);
+    EXPECT_THROW(BigInt::from_string("-", 16), std::exception);
+}
+
+TEST_F(BigIntTest, LargeBaseConversionRoundTrip) {
+    BigInt value = BigInt(3).mod_exp(BigInt(20000)) - BigInt(1);
+    for (unsigned base : {2u, 8u, 16u, 7u, 36u})
+    {
+        EXPECT_EQ(BigInt::from_string(value.to_string(base), base), value);
+    }
+    EXPECT_EQ(value.to_string(3), std::string(20000, '2'));
+}
+
+TEST_F(BigIntTest, StreamingReadParsesTokens) {
+    std::istringstream in("  1234567890123456789012345678901234567890\n-000456\t-0 7");
+    BigInt a, b, c, d;
+    in >> a >> b >> c >> d;
+    EXPECT_EQ(a, bigNum1);
+    EXPECT_EQ(b, neg456);
+    EXPECT_EQ(c, zero);
+    EXPECT_EQ(c.sign(), 0);
+    EXPECT_EQ(d, BigInt(7));
+    EXPECT_TRUE(in.eof());
+    BigInt e;
+    EXPECT_FALSE(in >> e);
+
+    std::istringstream bad("12x3");
+    EXPECT_THROW(bad >> e, std::exception);
+}
+
+TEST_F(BigIntTest, StreamingWriteAndReadRoundTrip) {
+    BigInt value = BigInt(7).mod_exp(BigInt(30000)) * BigInt(-1);
+    std::stringstream stream;
+    stream << value << ' ' << zero << ' ' << BigInt("1000000000000000000");
+    EXPECT_EQ(stream.str().substr(stream.str().size() - 22), " 0 1000000000000000000");
+    BigInt back, z, power;
+    stream >> back >> z >> power;
+    EXPECT_EQ(back, value);
+    EXPECT_EQ(z, zero);
+    EXPECT_EQ(power, BigInt("1000000000000000000"));
+}
+
+TEST_F(BigIntTest, UnbalancedMultiplicationMatchesSchoolbook) {
+    BigInt huge = BigInt(3).mod_exp(BigInt(6000)) + BigInt(12345);
+    BigInt medium = BigInt(7).mod_exp(BigInt(700)) - BigInt(1);
+    BigInt expected = huge * medium;
+    EXPECT_EQ(huge.karatsuba_multiply(medium), expected);
+    EXPECT_EQ(medium.fft_multiply(huge), expected);
+    EXPECT_EQ((huge * BigInt(-1)).fft_multiply(medium), expected * BigInt(-1));
+}
+
+TEST_F(BigIntTest, ToomAndFftPathsOnCloseLengths) {
+    BigInt a = BigInt(11).mod_exp(BigInt(3000)) - BigInt(1);
+    BigInt b = BigInt(13).mod_exp(BigInt(1900)) + BigInt(1);
+    BigInt expected = a * b;
+    EXPECT_EQ(a.karatsuba_multiply(b), expected);
+    EXPECT_EQ(a.fft_multiply(b), expected);
+    EXPECT_EQ(a.karatsuba_multiply(zero), zero);
+    EXPECT_EQ(zero.fft_multiply(b), zero);
+}
+
+TEST_F(BigIntTest, AccumulatorSumsWithDeferredCarries) {
+    BigIntAccumulator acc;
+    BigInt expected = 0;
+    for (int i = 0; i < 1000; i++)
+    {
+        acc.add(bigNum3);
+        expected += bigNum3;
+    }
+    acc.sub(bigNum1, 2);
+    acc.add_product(neg456, 12345678901234ULL, 1);
+    expected = expected - bigNum1 * BigInt("1000000000000000000") + neg456 * BigInt("12345678901234000000000");
+    EXPECT_EQ(acc.finalize(), expected);
+    EXPECT_EQ(BigIntAccumulator().finalize(), zero);
+}
+
+TEST_F(BigIntTest, AccumulatorMergesPerThreadParts) {
+    std::vector<BigIntAccumulator> parts(5);
+    BigInt expected = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        BigInt term = (i % 3 == 0 ? largeNeg : bigNum2) * BigInt(i);
+        parts[i % parts.size()].add(term);
+        expected += term;
+    }
+    EXPECT_EQ(BigIntAccumulator::merge(std::move(parts)).finalize(), expected);
+    EXPECT_EQ(bigNum5 * bigNum6, bigNum5.karatsuba_multiply(bigNum6));
+}
+
+TEST_F(BigIntTest, RnsRoundTripAndArithmetic) {
+    auto basis = RnsBasis::for_bits(400);
+    RnsBigInt a(basis, bigNum1), b(basis, largeNeg), c(basis, neg456);
+    EXPECT_EQ(a.to_bigint(), bigNum1);
+    EXPECT_EQ(b.to_bigint(), largeNeg);
+    EXPECT_EQ((a * b + c).to_bigint(), bigNum1 * largeNeg + neg456);
+    EXPECT_EQ((a * a * a - b * c).to_bigint(), bigNum1 * bigNum1 * bigNum1 - largeNeg * neg456);
+    EXPECT_EQ((-a).to_bigint(), bigNum1 * BigInt(-1));
+    EXPECT_EQ(RnsBigInt(basis, zero).to_bigint(), zero);
+}
+
+TEST_F(BigIntTest, RnsBasisValidation) {
+    RnsBasis small({7, 11, 13});
+    EXPECT_EQ(small.modulus(), BigInt(1001));
+    EXPECT_EQ(small.reduce(BigInt(-1)), (std::vector<uint32_t>{6, 10, 12}));
+    EXPECT_EQ(small.reconstruct({6, 10, 12}), BigInt(-1));
+    EXPECT_EQ(small.reconstruct(small.reduce(BigInt(500))), BigInt(500));
+    EXPECT_THROW(RnsBasis({7, 9}), std::exception);
+    EXPECT_THROW(RnsBasis({7, 7}), std::exception);
+    auto one = RnsBasis::for_bits(64), other = RnsBasis::for_bits(64);
+    EXPECT_THROW(RnsBigInt(one, pos123) + RnsBigInt(other, pos123), std::exception);
+}
+
+TEST_F(BigIntTest, TruncatedProductsMatchFullProduct) {
+    BigInt a = BigInt(3).mod_exp(BigInt(6000)) + BigInt(12345);
+    BigInt b = BigInt(7).mod_exp(BigInt(2000)) - BigInt(1);
+    BigInt full = a * b;
+    BigInt low_base = BigInt(1000000000).mod_exp(BigInt(100));
+    BigInt high_base = BigInt(1000000000).mod_exp(BigInt(200));
+    EXPECT_EQ(a.mul_low(b, 200), full % high_base);
+    EXPECT_EQ((a * BigInt(-1)).mul_low(b, 200), (full % high_base) * BigInt(-1));
+    BigInt high = a.mul_high(b, 200), exact_high = full / high_base;
+    EXPECT_TRUE(high == exact_high || high + BigInt(1) == exact_high);
+    BigInt middle = a.mul_middle(b, 100, 300), exact_middle = (full / low_base) % high_base;
+    EXPECT_TRUE(middle == exact_middle || (middle + BigInt(1)) % high_base == exact_middle);
+    EXPECT_EQ(a.mul_low(zero, 10), zero);
+}
+
+TEST_F(BigIntTest, NewtonDivisionMatchesLongDivision) {
+    BigInt f = BigInt(3).mod_exp(BigInt(9000)) + BigInt(7);
+    BigInt g = BigInt(7).mod_exp(BigInt(2500)) + BigInt(1);
+    EXPECT_EQ(f.newton_divide(g), f / g);
+    EXPECT_EQ((f * BigInt(-1)).newton_divide(g), (f / g) * BigInt(-1));
+    EXPECT_EQ(BigInt(100).newton_divide(BigInt(7)), BigInt(14));
+    EXPECT_EQ(pos123.newton_divide(bigNum1), zero);
+    EXPECT_THROW(pos123.newton_divide(zero), std::exception);
+}
+
+TEST_F(BigIntTest, FixedBaseExponentiationMatchesModExp) {
+    BigInt prime = BigInt(2).mod_exp(BigInt(521)) - BigInt(1);
+    FixedBaseExponentiator fixed(BigInt(5), prime);
+    for (const BigInt &e : {zero, BigInt(1), BigInt(12345), BigInt(3).mod_exp(BigInt(300)), BigInt(2).mod_exp(BigInt(520)) + BigInt(17)}) {
+        EXPECT_EQ(fixed.pow(e), BigInt(5).mod_exp(e, prime));
+    }
+
+    BigInt even = BigInt(10).mod_exp(BigInt(40)) + BigInt(2);
+    FixedBaseExponentiator plain(BigInt(-7), even, 64, 3);
+    BigInt base = even - BigInt(7), short_exp = BigInt("18446744073709551615"), long_exp = BigInt(3).mod_exp(BigInt(100));
+    EXPECT_EQ(plain.pow(short_exp), base.mod_exp(short_exp, even));
+    EXPECT_EQ(plain.pow(long_exp), base.mod_exp(long_exp, even));
+    EXPECT_THROW(plain.pow(BigInt(-1)), std::exception);
+    EXPECT_THROW(FixedBaseExponentiator(BigInt(2), BigInt(1)), std::exception);
+}
+
+TEST_F(BigIntTest, FixedBaseTableRoundTrip) {
+    BigInt modulus = BigInt(2).mod_exp(BigInt(255)) - BigInt(19);
+    FixedBaseExponentiator fixed(BigInt(9), modulus);
+    std::stringstream stream;
+    fixed.write(stream);
+    std::string bytes = stream.str();
+
+    std::stringstream copy(bytes);
+    FixedBaseExponentiator loaded = FixedBaseExponentiator::read(copy);
+    EXPECT_EQ(loaded.modulus(), modulus);
+    EXPECT_EQ(loaded.window(), fixed.window());
+    BigInt e = BigInt(7).mod_exp(BigInt(80));
+    EXPECT_EQ(loaded.pow(e), fixed.pow(e));
+
+    bytes[0] = 'X';
+    std::stringstream broken(bytes);
+    EXPECT_THROW(FixedBaseExponentiator::read(broken), std::exception);
+    std::stringstream truncated(stream.str().substr(0, 100));
+    EXPECT_THROW(FixedBaseExponentiator::read(truncated), std::exception);
+}
+
+TEST_F(BigIntTest, PolyMultiplicationOverIntegersAndPrimes) {
+    // (x - 2)(x + 3) = x^2 + x - 6
+    EXPECT_EQ(Poly({BigInt(-2), BigInt(1)}) * Poly({BigInt(3), BigInt(1)}), Poly({BigInt(-6), BigInt(1), BigInt(1)}));
+
+    std::vector<BigInt> a, b;
+    for (int i = 0; i < 40; i++) {
+        a.push_back(bigNum1 * BigInt(i % 7 - 3) + BigInt(i));
+        b.push_back(largeNeg * BigInt(i % 5) - BigInt(i * i));
+    }
+    std::vector<BigInt> expected(a.size() + b.size() - 1, BigInt(0));
+    for (size_t i = 0; i < a.size(); i++) {
+        for (size_t j = 0; j < b.size(); j++) {
+            expected[i + j] += a[i] * b[j];
+        }
+    }
+    EXPECT_EQ(Poly(a) * Poly(b), Poly(expected));
+    BigInt ntt_prime(998244353), big_prime = BigInt(2).mod_exp(BigInt(127)) - BigInt(1);
+    EXPECT_EQ(Poly(a, ntt_prime) * Poly(b, ntt_prime), Poly(expected, ntt_prime));
+    EXPECT_EQ(Poly(a, big_prime) * Poly(b, big_prime), Poly(expected, big_prime));
+    EXPECT_THROW(Poly(a, ntt_prime) * Poly(b), std::exception);
+}
+
+TEST_F(BigIntTest, PolyNewtonInverseAndDivision) {
+    BigInt p = BigInt(2).mod_exp(BigInt(61)) - BigInt(1);
+    std::vector<BigInt> a, b;
+    for (int i = 0; i < 150; i++) {
+        a.push_back(BigInt(3).mod_exp(BigInt(i + 40)) + BigInt(i));
+    }
+    for (int i = 0; i < 60; i++) {
+        b.push_back(BigInt(7).mod_exp(BigInt(i + 5)) - BigInt(1));
+    }
+    Poly f(a, p), g(b, p);
+    auto [q, r] = f.divmod(g);
+    EXPECT_EQ(q * g + r, f);
+    EXPECT_LT(r.degree(), g.degree());
+    EXPECT_EQ(f / g, q);
+    EXPECT_EQ(f % g, r);
+
+    std::vector<BigInt> series = (f * f.inverse(100)).coefficients();
+    series.resize(100);
+    EXPECT_EQ(Poly(series, p), Poly({BigInt(1)}, p));
+
+    // Над Z делить можно только на многочлен со старшим коэффициентом +-1
+    Poly monic({BigInt(5), BigInt(0), BigInt(1)});
+    auto [qz, rz] = Poly(a).divmod(monic);
+    EXPECT_EQ(qz * monic + rz, Poly(a));
+    EXPECT_THROW(Poly(a).divmod(Poly({BigInt(1), BigInt(2)})), std::exception);
+}
+
+TEST_F(BigIntTest, PolyNewtonInverseAndDivisionOverWordPrimes) {
+    for (long long prime : {1000000007LL, 998244353LL, 2147483647LL}) {
+        BigInt p(prime);
+        std::vector<BigInt> a, b;
+        for (int i = 0; i < 150; i++) {
+            a.push_back(BigInt(prime - 1 - i * i));
+        }
+        for (int i = 0; i < 60; i++) {
+            b.push_back(BigInt(prime / 3 + i * 7919));
+        }
+        Poly f(a, p), g(b, p);
+        for (size_t n : {17, 33, 100}) {
+            std::vector<BigInt> series = (f * f.inverse(n)).coefficients();
+            series.resize(n);
+            EXPECT_EQ(Poly(series, p), Poly({BigInt(1)}, p));
+        }
+        auto [q, r] = f.divmod(g);
+        EXPECT_LT(r.degree(), g.degree());
+        EXPECT_EQ(q * g + r, f);
+    }
+}
+
+TEST_F(BigIntTest, PolyMultipointEvaluationAndInterpolation) {
+    BigInt p(1000000007);
+    std::vector<BigInt> coeffs, xs;
+    for (int i = 0; i < 200; i++) {
+        coeffs.push_back(BigInt(i * 31 + 7));
+        xs.push_back(BigInt(i * i + 1));
+    }
+    Poly f(coeffs, p);
+    std::vector<BigInt> values = f.evaluate(xs);
+    for (size_t i = 0; i < xs.size(); i += 17) {
+        EXPECT_EQ(values[i], f.evaluate(xs[i]));
+    }
+    EXPECT_EQ(Poly::interpolate(xs, values, p), f);
+
+    xs[1] = xs[0];
+    EXPECT_THROW(Poly::interpolate(xs, values, p), std::exception);
+}
+
+TEST_F(BigIntTest, CopiesKeepValueSemantics) {
+    BigInt original = bigNum1 * bigNum2;
+    const BigInt snapshot = original;
+    BigInt copy = original;
+    copy += BigInt(1);
+    EXPECT_EQ(original, snapshot);
+    EXPECT_EQ(copy - BigInt(1), original);
+
+    std::vector<BigInt> values(4, original);
+    values[2] *= BigInt(3);
+    EXPECT_EQ(values[0], snapshot);
+    EXPECT_EQ(values[2], snapshot * BigInt(3));
+
+    std::vector<std::future<BigInt>> parts;
+    for (int i = 0; i < 4; i++) {
+        parts.push_back(std::async(std::launch::async, [copy = original, i]() mutable {
+            copy += BigInt(i);
+            return copy;
+        }));
+    }
+    for (int i = 0; i < 4; i++) {
+        EXPECT_EQ(parts[i].get(), snapshot + BigInt(i));
+    }
+    EXPECT_EQ(original, snapshot);
+}
+
+#ifndef BIGINT_NO_COW
+TEST_F(BigIntTest, LimbBufferSharesUntilFirstWrite) {
+    LimbBuffer first(std::vector<unsigned long long>{1, 2, 3});
+    LimbBuffer second = first;
+    EXPECT_EQ(first.use_count(), 2u);
+    EXPECT_EQ(std::as_const(second).data(), std::as_const(first).data());
+
+    second[0] = 7;
+    EXPECT_EQ(first.use_count(), 1u);
+    EXPECT_EQ(second.use_count(), 1u);
+    EXPECT_EQ(first[0], 1u);
+    EXPECT_EQ(second[0], 7u);
+
+    LimbBuffer third = first;
+    third.clear();
+    EXPECT_TRUE(third.empty());
+    EXPECT_EQ(first.size(), 3u);
+}
+#endif
+
+TEST_F(BigIntTest, AsyncOperationsMatchSynchronousOnes) {
+    BigInt a = BigInt(3).mod_exp(BigInt(40000)) + BigInt(11), b = BigInt(7).mod_exp(BigInt(12000)) - BigInt(5);
+    std::vector<double> reports;
+    std::mutex reports_mutex;
+    auto record = [&](double done) {
+        std::lock_guard<std::mutex> lock(reports_mutex);
+        reports.push_back(done);
+    };
+
+    EXPECT_EQ(a.multiply_async(b, {}, record).get(), a.karatsuba_multiply(b));
+    ASSERT_FALSE(reports.empty());
+    EXPECT_TRUE(std::is_sorted(reports.begin(), reports.end()));
+    EXPECT_EQ(reports.back(), 1.0);
+
+    EXPECT_EQ((a * BigInt(-1)).divide_async(b).get(), (a * BigInt(-1)).newton_divide(b));
+    BigInt modulus = BigInt(2).mod_exp(BigInt(127)) - BigInt(1);
+    EXPECT_EQ(a.mod_exp_async(b, modulus).get(), a.mod_exp(b, modulus));
+
+    auto inline_executor = [](std::function<void()> task) { task(); };
+    std::future<BigInt> on_executor = a.multiply_async(inline_executor, b);
+    ASSERT_EQ(on_executor.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+    EXPECT_EQ(on_executor.get(), a.karatsuba_multiply(b));
+}
+
+TEST_F(BigIntTest, AsyncOperationsStopOnRequest) {
+    BigInt a = BigInt(3).mod_exp(BigInt(40000)), b = BigInt(7).mod_exp(BigInt(12000));
+    std::stop_source stop;
+    stop.request_stop();
+    EXPECT_THROW(a.multiply_async(b, stop.get_token()).get(), BigInt::Cancelled);
+    EXPECT_THROW(a.divide_async(b, stop.get_token()).get(), BigInt::Cancelled);
+    EXPECT_THROW(a.mod_exp_async(b, BigInt(1000003), stop.get_token()).get(), BigInt::Cancelled);
+
+    // Остановка посреди умножения: проверка срабатывает на ближайшем уровне рекурсии
+    std::stop_source midway;
+    std::future<BigInt> product = a.multiply_async(b, midway.get_token(), [&midway](double done) {
+        if (done > 0.3) {
+            midway.request_stop();
+        }
+    });
+    EXPECT_THROW(product.get(), BigInt::Cancelled);
+    EXPECT_EQ(a * BigInt(2), a + a);
+}
+
+TEST_F(BigIntTest, OutOfCoreMultiplicationMatchesInMemory) {
+    const std::string dir = ::testing::TempDir();
+    const std::string a_path = dir + "ooc_a.bin", b_path = dir + "ooc_b.bin", out_path = dir + "ooc_product.bin";
+    BigInt a = BigInt(3).mod_exp(BigInt(50000)) + BigInt(17), b = (BigInt(7).mod_exp(BigInt(21000)) - BigInt(1)) * BigInt(-1);
+    BigIntFile::save(a_path, a);
+    BigIntFile::save(b_path, b);
+
+    // Бюджет 32 КБ: разряды не помещаются в буфер, свёртка идёт через файлы по полосам
+    OutOfCoreMultiplier multiplier({size_t(32) << 10, dir});
+    MappedBigInt product = multiplier.multiply(a_path, b_path, out_path);
+    EXPECT_TRUE(product.is_negative());
+    EXPECT_EQ(product.to_bigint(), a.karatsuba_multiply(b));
+    EXPECT_EQ(multiplier.multiply(a_path, a_path, out_path).to_bigint(), a.karatsuba_multiply(a));
+
+    // Наименьший бюджет: длинные столбцы и по несколько столбцов в полосе
+    BigInt a2 = a.karatsuba_multiply(a), c = a2.karatsuba_multiply(a2).karatsuba_multiply(a) - BigInt(1);
+    BigIntFile::save(a_path, c);
+    EXPECT_EQ(OutOfCoreMultiplier({OutOfCoreMultiplier::MIN_BUDGET, dir}).multiply(a_path, b_path, out_path).to_bigint(), c.karatsuba_multiply(b));
+
+    BigIntFile::save(b_path, BigInt(0));
+    EXPECT_EQ(multiplier.multiply(a_path, b_path, out_path).to_bigint(), BigInt(0));
+    EXPECT_THROW(OutOfCoreMultiplier({1024, dir}), std::exception);
+    std::remove(a_path.c_str());
+    std::remove(b_path.c_str());
+    std::remove(out_path.c_str());
+}
+
+TEST_F(BigIntTest, TelemetryCountsOperationsPerTier) {
+    BigInt::telemetry_reset();
+    BigInt a = BigInt(3).mod_exp(BigInt(20000)), b = BigInt(7).mod_exp(BigInt(9000));
+    BigInt product = a.karatsuba_multiply(b);
+    EXPECT_EQ(product.newton_divide(b), a);
+    std::thread([&a] { EXPECT_EQ(a.fft_multiply(a), a.karatsuba_multiply(a)); }).join();
+
+    const BigInt::TelemetrySnapshot snapshot = BigInt::telemetry_snapshot();
+    const std::string text = snapshot.prometheus();
+    EXPECT_NE(text.find("# TYPE bigint_calls_total counter"), std::string::npos);
+    EXPECT_NE(text.find("bigint_seconds_total{operation=\"div\",tier=\"newton\"}"), std::string::npos);
+    if constexpr (BigInt::TELEMETRY_ENABLED)
+    {
+        EXPECT_GT(snapshot[BigInt::TelemetryOp::mul_toom32].calls + snapshot[BigInt::TelemetryOp::mul_karatsuba].calls, 0u);
+        EXPECT_GT(snapshot[BigInt::TelemetryOp::mul_schoolbook].limbs, 0u);
+        EXPECT_EQ(snapshot[BigInt::TelemetryOp::div_newton].calls, 1u);
+        EXPECT_GT(snapshot[BigInt::TelemetryOp::div_newton].allocations, 0u);
+        EXPECT_GT(snapshot[BigInt::TelemetryOp::div_newton].nanoseconds, 0u);
+        // Счётчики завершившегося потока остаются в итоге
+        EXPECT_GT(snapshot[BigInt::TelemetryOp::mul_fft].calls, 0u);
+        BigInt::telemetry_reset();
+        EXPECT_EQ(BigInt::telemetry_snapshot()[BigInt::TelemetryOp::mul_fft].calls, 0u);
+    }
+    else
+    {
+        EXPECT_EQ(snapshot[BigInt::TelemetryOp::div_newton].calls, 0u);
+        EXPECT_EQ(snapshot[BigInt::TelemetryOp::mul_schoolbook].limbs, 0u);
+    }
+}
+
+TEST_F(BigIntTest, FloatingPointScalingAndConversions)
+{
+    EXPECT_EQ(BigInt(5) * 0.5, BigInt(2));
+    EXPECT_EQ(BigInt(7) * 0.5, BigInt(4));
+    EXPECT_EQ(BigInt(-7) * -1.5, BigInt(10));
+    EXPECT_EQ(BigInt("123456789012345678901234567890") * 1e-300, BigInt(0));
+    EXPECT_EQ(BigInt(3).scale(std::ldexp(1.0, 100)), BigInt(3) * BigInt(2).mod_exp(BigInt(100)));
+    EXPECT_EQ(BigInt(1000).scale(-0.1), BigInt(-100));
+    EXPECT_THROW(BigInt(1) * std::nan(""), std::exception);
+
+    EXPECT_EQ(BigInt("9007199254740993").to_double(), 9007199254740992.0);
+    EXPECT_EQ(BigInt("9007199254740995").to_double(), 9007199254740996.0);
+    EXPECT_EQ(BigInt("-12345").to_double(), -12345.0);
+    EXPECT_EQ(BigInt(10).mod_exp(BigInt(308)).to_double(), 1e308);
+    EXPECT_TRUE(std::isinf(BigInt(10).mod_exp(BigInt(400)).to_double()));
+
+    EXPECT_EQ(BigInt::from_double(1e300).to_double(), 1e300);
+    EXPECT_EQ(BigInt::from_double(std::ldexp(1.0, 70)), BigInt(2).mod_exp(BigInt(70)));
+    EXPECT_EQ(BigInt::from_double(-2.7), BigInt(-2));
+    EXPECT_THROW(BigInt::from_double(INFINITY), std::exception);
+}
+
+TEST_F(BigIntTest, SquareMatchesMultiplication)
+{
+    std::mt19937_64 rng(49);
+    for (size_t limbs : {1, 5, 31, 32, 33, 200, 2600})
+    {
+        std::string s(limbs * 9, '9');
+        for (size_t i = limbs % 2; i < s.size(); i++)
+        {
+            s[i] = (char)('0' + rng() % 10);
+        }
+        s[0] = '9';
+        BigInt a(s);
+        EXPECT_EQ(a.square(), a * a);
+        EXPECT_EQ((a * -1).square(), a * a);
+    }
+}
+
+TEST_F(BigIntTest, FibonacciLucasAndMatrixPower)
+{
+    BigInt f0 = 0, f1 = 1, l0 = 2, l1 = 1;
+    for (unsigned long long n = 0; n <= 300; n++)
+    {
+        EXPECT_EQ(Recurrence::fib(n), f0);
+        EXPECT_EQ(Recurrence::lucas(n), l0);
+        BigInt f2 = f0 + f1, l2 = l0 + l1;
+        f0 = f1;
+        f1 = f2;
+        l0 = l1;
+        l1 = l2;
+    }
+
+    const BigInt f = Recurrence::fib(5000), l = Recurrence::lucas(5000);
+    for (const char *mod : {"1000000007", "1000000000", "1", "98765432109876543210987654321"})
+    {
+        EXPECT_EQ(Recurrence::fib(BigInt(5000), BigInt(mod)), f % BigInt(mod));
+        EXPECT_EQ(Recurrence::lucas(BigInt(5000), BigInt(mod)), l % BigInt(mod));
+    }
+    const BigInt long_mod = BigInt(10).mod_exp(BigInt(700)) + BigInt(3);
+    EXPECT_EQ(Recurrence::fib(BigInt(5000), long_mod), f % long_mod);
+    // F(n) делит F(kn)
+    EXPECT_EQ(Recurrence::fib(BigInt("1234000000000000000000"), Recurrence::fib(1234)), BigInt(0));
+    EXPECT_THROW(Recurrence::fib(BigInt(-1), BigInt(7)), std::exception);
+    EXPECT_THROW(Recurrence::fib(BigInt(10), BigInt(0)), std::exception);
+
+    Recurrence::Matrix2 q = Recurrence::matrix_pow({1, 1, 1, 0}, BigInt(5000));
+    EXPECT_EQ(q.b, f);
+    EXPECT_EQ(q.a, q.b + q.d);
+    q = Recurrence::matrix_pow({1, 1, 1, 0}, BigInt(5000), BigInt(1000000000));
+    EXPECT_EQ(q.c, f % BigInt(1000000000));
+    Recurrence::Matrix2 r = Recurrence::matrix_pow({0, -1, 1, 0}, BigInt(6));
+    EXPECT_EQ(r.a, BigInt(-1));
+    EXPECT_EQ(r.b, BigInt(0));
+    r = Recurrence::matrix_pow({0, -1, 1, 0}, BigInt(6), BigInt(-7));
+    EXPECT_EQ(r.d, BigInt(6));
+    r = Recurrence::matrix_pow({2, 3, 5, 7}, BigInt(0), BigInt(11));
+    EXPECT_EQ(r.a, BigInt(1));
+    EXPECT_EQ(r.c, BigInt(0));
+}
+
 int main(int argc, char **argv)
 {
     ::testing::InitGoogleTest(&argc, argv);
@@ -4,6 +4,8 @@
 #include <exception>   
 #include <compare> 
 #include <iostream>
+#include <algorithm>
+#include <utility>
 
 template <typename T>
 class IComparator
@@ -156,6 +158,8 @@ public:
         virtual ~InorderIterator() = default;
     };
 
+    using iterator = InorderIterator;
+
     Node *_head;
     size_t _size;
     size_t _depth;
@@ -414,6 +418,566 @@ private:
     }
 };
 
+// Красно-чёрное дерево с интерфейсом BST. Высота не больше 2 log(n + 1) при любом порядке ключей,
+// поэтому вставка, удаление и поиск - O(log n). Все операции итеративные, рекурсии по глубине нет.
+// Повторная вставка ключа заменяет значение
+template <typename Key, typename Value, template <typename> typename Comporator = DefaultComparator>
+class RedBlackTree
+{
+protected:
+    Comporator<Key> comp = Comporator<Key>();
+
+    enum class Color
+    {
+        red,
+        black
+    };
+
+    struct Node
+    {
+        Key key;
+        Value value;
+        Node *left = nullptr, *right = nullptr, *parent = nullptr;
+        Color color = Color::red;
+
+        Node(const Key &_key, const Value &_value, Node *_parent) : key(_key), value(_value), parent(_parent) {}
+    };
+
+    enum class Order
+    {
+        pre,
+        in,
+        post
+    };
+
+public:
+    // Переход к следующему узлу - по указателям на родителя, без очереди всех узлов
+    class InorderIterator
+    {
+        friend class RedBlackTree;
+
+    protected:
+        Node *_node;
+
+    public:
+        InorderIterator() : _node(nullptr) {}
+        InorderIterator(Node *node) : _node(node) {}
+
+        InorderIterator &operator++()
+        {
+            _node = successor(_node);
+            return *this;
+        }
+
+        InorderIterator operator++(int)
+        {
+            InorderIterator ret(*this);
+            _node = successor(_node);
+            return ret;
+        }
+
+        Value &operator*() const
+        {
+            return _node->value;
+        }
+
+        const Key &key() const
+        {
+            return _node->key;
+        }
+
+        bool operator==(const InorderIterator &other) const
+        {
+            return _node == other._node;
+        }
+
+        bool operator!=(const InorderIterator &other) const
+        {
+            return _node != other._node;
+        }
+    };
+
+    using iterator = InorderIterator;
+
+    RedBlackTree() : _head(nullptr), _size(0) {}
+
+    RedBlackTree(const RedBlackTree &other) : comp(other.comp), _head(clone(other._head, nullptr)), _size(other._size) {}
+
+    RedBlackTree(RedBlackTree &&other) noexcept : comp(other.comp), _head(other._head), _size(other._size)
+    {
+        other._head = nullptr;
+        other._size = 0;
+    }
+
+    RedBlackTree &operator=(RedBlackTree other) noexcept
+    {
+        std::swap(comp, other.comp);
+        std::swap(_head, other._head);
+        std::swap(_size, other._size);
+        return *this;
+    }
+
+    ~RedBlackTree()
+    {
+        clear();
+    }
+
+    InorderIterator begin() const
+    {
+        return InorderIterator(leftmost(_head));
+    }
+
+    InorderIterator end() const
+    {
+        return InorderIterator(nullptr);
+    }
+
+    // Узлы удаляются снизу вверх: лист отцепляется от родителя, и обход продолжается с родителя
+    void clear()
+    {
+        Node *node = _head;
+        while (node != nullptr)
+        {
+            if (node->left != nullptr)
+            {
+                node = node->left;
+            }
+            else if (node->right != nullptr)
+            {
+                node = node->right;
+            }
+            else
+            {
+                Node *parent = node->parent;
+                if (parent != nullptr)
+                {
+                    (parent->left == node ? parent->left : parent->right) = nullptr;
+                }
+                delete node;
+                node = parent;
+            }
+        }
+        _head = nullptr;
+        _size = 0;
+    }
+
+    void inorderTraversal(std::function<void(const Key &, const Value &)> func) const
+    {
+        traverse(Order::in, func);
+    }
+
+    void preorderTraversal(std::function<void(const Key &, const Value &)> func) const
+    {
+        traverse(Order::pre, func);
+    }
+
+    void postorderTraversal(std::function<void(const Key &, const Value &)> func) const
+    {
+        traverse(Order::post, func);
+    }
+
+    void insert(const Key &key, const Value &value)
+    {
+        Node *parent = nullptr, *cur = _head;
+        bool toLeft = false;
+        while (cur != nullptr)
+        {
+            parent = cur;
+            if (comp.compare(key, cur->key))
+            {
+                cur = cur->left;
+                toLeft = true;
+            }
+            else if (comp.compare(cur->key, key))
+            {
+                cur = cur->right;
+                toLeft = false;
+            }
+            else
+            {
+                cur->value = value;
+                return;
+            }
+        }
+
+        Node *node = new Node(key, value, parent);
+        if (parent == nullptr)
+        {
+            _head = node;
+        }
+        else if (toLeft)
+        {
+            parent->left = node;
+        }
+        else
+        {
+            parent->right = node;
+        }
+        ++_size;
+        insert_fixup(node);
+    }
+
+    void remove(const Key &key)
+    {
+        Node *toRemove = find_node(key);
+        if (toRemove == nullptr)
+        {
+            throw std::exception();
+        }
+
+        // x встаёт на место вынутого из дерева узла; x может быть nullptr, поэтому его родитель хранится отдельно
+        Color removedColor = toRemove->color;
+        Node *x, *xParent;
+        if (toRemove->left == nullptr)
+        {
+            x = toRemove->right;
+            xParent = toRemove->parent;
+            transplant(toRemove, toRemove->right);
+        }
+        else if (toRemove->right == nullptr)
+        {
+            x = toRemove->left;
+            xParent = toRemove->parent;
+            transplant(toRemove, toRemove->left);
+        }
+        else
+        {
+            // Два потомка: на место узла встаёт следующий за ним, сами узлы не копируются,
+            // так что итераторы на остальные элементы остаются действительными
+            Node *next = leftmost(toRemove->right);
+            removedColor = next->color;
+            x = next->right;
+            if (next->parent == toRemove)
+            {
+                xParent = next;
+            }
+            else
+            {
+                xParent = next->parent;
+                transplant(next, next->right);
+                next->right = toRemove->right;
+                next->right->parent = next;
+            }
+            transplant(toRemove, next);
+            next->left = toRemove->left;
+            next->left->parent = next;
+            next->color = toRemove->color;
+        }
+        delete toRemove;
+        --_size;
+
+        if (removedColor == Color::black)
+        {
+            remove_fixup(x, xParent);
+        }
+    }
+
+    Value *find(const Key &key) const
+    {
+        Node *res = find_node(key);
+        return res != nullptr ? &res->value : nullptr;
+    }
+
+    bool contains(const Key &key) const
+    {
+        return find_node(key) != nullptr;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    // Число уровней дерева (0 у пустого)
+    size_t height() const
+    {
+        size_t height = 0, depth = 0;
+        Node *node = _head, *prev = nullptr;
+        while (node != nullptr)
+        {
+            Node *next = next_in_walk(node, prev);
+            if (prev == node->parent)
+            {
+                ++depth;
+                height = std::max(height, depth);
+            }
+            if (next == node->parent)
+            {
+                --depth;
+            }
+            prev = node;
+            node = next;
+        }
+        return height;
+    }
+
+private:
+    Node *_head;
+    size_t _size;
+
+    static bool is_red(const Node *node)
+    {
+        return node != nullptr && node->color == Color::red;
+    }
+
+    static Node *leftmost(Node *node)
+    {
+        while (node != nullptr && node->left != nullptr)
+        {
+            node = node->left;
+        }
+        return node;
+    }
+
+    static Node *successor(Node *node)
+    {
+        if (node->right != nullptr)
+        {
+            return leftmost(node->right);
+        }
+        while (node->parent != nullptr && node == node->parent->right)
+        {
+            node = node->parent;
+        }
+        return node->parent;
+    }
+
+    static Node *clone(const Node *node, Node *parent)
+    {
+        if (node == nullptr)
+        {
+            return nullptr;
+        }
+        Node *copy = new Node(node->key, node->value, parent);
+        copy->color = node->color;
+        copy->left = clone(node->left, copy);
+        copy->right = clone(node->right, copy);
+        return copy;
+    }
+
+    Node *find_node(const Key &key) const
+    {
+        Node *cur = _head;
+        while (cur != nullptr)
+        {
+            if (comp.compare(key, cur->key))
+            {
+                cur = cur->left;
+            }
+            else if (comp.compare(cur->key, key))
+            {
+                cur = cur->right;
+            }
+            else
+            {
+                return cur;
+            }
+        }
+        return nullptr;
+    }
+
+    // Следующий узел обхода в глубину по указателям на родителя; prev - узел, из которого пришли в node
+    static Node *next_in_walk(Node *node, Node *prev)
+    {
+        if (prev == node->parent && node->left != nullptr)
+        {
+            return node->left;
+        }
+        if (prev != node->right && node->right != nullptr)
+        {
+            return node->right;
+        }
+        return node->parent;
+    }
+
+    void traverse(Order order, const std::function<void(const Key &, const Value &)> &func) const
+    {
+        Node *node = _head, *prev = nullptr;
+        while (node != nullptr)
+        {
+            Node *next = next_in_walk(node, prev);
+            const bool entered = prev == node->parent;
+            const bool leftDone = entered ? node->left == nullptr : prev == node->left;
+            if ((order == Order::pre && entered) || (order == Order::in && leftDone) || (order == Order::post && next == node->parent))
+            {
+                func(node->key, node->value);
+            }
+            prev = node;
+            node = next;
+        }
+    }
+
+    // Ставит поддерево v на место поддерева u
+    void transplant(Node *u, Node *v)
+    {
+        if (u->parent == nullptr)
+        {
+            _head = v;
+        }
+        else if (u == u->parent->left)
+        {
+            u->parent->left = v;
+        }
+        else
+        {
+            u->parent->right = v;
+        }
+        if (v != nullptr)
+        {
+            v->parent = u->parent;
+        }
+    }
+
+    void rotate_left(Node *x)
+    {
+        Node *y = x->right;
+        x->right = y->left;
+        if (y->left != nullptr)
+        {
+            y->left->parent = x;
+        }
+        transplant(x, y);
+        y->left = x;
+        x->parent = y;
+    }
+
+    void rotate_right(Node *x)
+    {
+        Node *y = x->left;
+        x->left = y->right;
+        if (y->right != nullptr)
+        {
+            y->right->parent = x;
+        }
+        transplant(x, y);
+        y->right = x;
+        x->parent = y;
+    }
+
+    // Восстановление свойств после вставки красного узла: перекраска при красном дяде, иначе один-два поворота
+    void insert_fixup(Node *node)
+    {
+        while (is_red(node->parent))
+        {
+            Node *parent = node->parent, *grand = parent->parent;
+            if (parent == grand->left)
+            {
+                Node *uncle = grand->right;
+                if (is_red(uncle))
+                {
+                    parent->color = Color::black;
+                    uncle->color = Color::black;
+                    grand->color = Color::red;
+                    node = grand;
+                    continue;
+                }
+                if (node == parent->right)
+                {
+                    rotate_left(parent);
+                    parent = node;
+                }
+                parent->color = Color::black;
+                grand->color = Color::red;
+                rotate_right(grand);
+                break;
+            }
+            else
+            {
+                Node *uncle = grand->left;
+                if (is_red(uncle))
+                {
+                    parent->color = Color::black;
+                    uncle->color = Color::black;
+                    grand->color = Color::red;
+                    node = grand;
+                    continue;
+                }
+                if (node == parent->left)
+                {
+                    rotate_right(parent);
+                    parent = node;
+                }
+                parent->color = Color::black;
+                grand->color = Color::red;
+                rotate_left(grand);
+                break;
+            }
+        }
+        _head->color = Color::black;
+    }
+
+    // Восстановление чёрной высоты после удаления чёрного узла; у x на ней не хватает одного чёрного
+    void remove_fixup(Node *x, Node *parent)
+    {
+        while (x != _head && !is_red(x))
+        {
+            if (x == parent->left)
+            {
+                Node *sibling = parent->right;
+                if (is_red(sibling))
+                {
+                    sibling->color = Color::black;
+                    parent->color = Color::red;
+                    rotate_left(parent);
+                    sibling = parent->right;
+                }
+                if (!is_red(sibling->left) && !is_red(sibling->right))
+                {
+                    sibling->color = Color::red;
+                    x = parent;
+                    parent = x->parent;
+                    continue;
+                }
+                if (!is_red(sibling->right))
+                {
+                    sibling->left->color = Color::black;
+                    sibling->color = Color::red;
+                    rotate_right(sibling);
+                    sibling = parent->right;
+                }
+                sibling->color = parent->color;
+                parent->color = Color::black;
+                sibling->right->color = Color::black;
+                rotate_left(parent);
+            }
+            else
+            {
+                Node *sibling = parent->left;
+                if (is_red(sibling))
+                {
+                    sibling->color = Color::black;
+                    parent->color = Color::red;
+                    rotate_right(parent);
+                    sibling = parent->left;
+                }
+                if (!is_red(sibling->left) && !is_red(sibling->right))
+                {
+                    sibling->color = Color::red;
+                    x = parent;
+                    parent = x->parent;
+                    continue;
+                }
+                if (!is_red(sibling->left))
+                {
+                    sibling->right->color = Color::black;
+                    sibling->color = Color::red;
+                    rotate_left(sibling);
+                    sibling = parent->left;
+                }
+                sibling->color = parent->color;
+                parent->color = Color::black;
+                sibling->left->color = Color::black;
+                rotate_right(parent);
+            }
+            x = _head;
+        }
+        if (x != nullptr)
+        {
+            x->color = Color::black;
+        }
+    }
+};
+
 template <typename T, typename F>
 using callback = std::function<void(const T &, const F &)>;
 
@@ -423,6 +987,8 @@ class MyMap
     TreeType<Key, Value, Comparator> _tree;
 
 public:
+    using iterator = typename TreeType<Key, Value, Comparator>::iterator;
+
     MyMap()
     {
         _tree = TreeType<Key, Value, Comparator>();
@@ -458,11 +1024,11 @@ public:
         return _tree.size();
     }
 
-    BST<Key, Value, Comparator>::InorderIterator begin()
+    iterator begin()
     {
         return _tree.begin();
     }
-    BST<Key, Value, Comparator>::InorderIterator end()
+    iterator end()
     {
         return _tree.end();
     }
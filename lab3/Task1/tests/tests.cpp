@@ -141,6 +141,69 @@ TEST_F(MyMapTest, GreaterComparatorWorks) {
     EXPECT_EQ(keys[2], 1);
 }
 
+TEST_F(MyMapTest, RedBlackTreeMapSupportsAllOperations) {
+    MyMap<int, std::string, RedBlackTree> map;
+    map.insert(2, "two");
+    map.insert(1, "one");
+    map.insert(3, "three");
+    map.insert(2, "TWO");
+    EXPECT_EQ(map.size(), 3);
+    ASSERT_NE(map.find(2), nullptr);
+    EXPECT_EQ(*map.find(2), "TWO");
+
+    std::vector<std::string> values;
+    for (auto it = map.begin(); it != map.end(); it++) {
+        values.push_back(*it);
+    }
+    EXPECT_EQ(values, (std::vector<std::string>{"one", "TWO", "three"}));
+
+    map.remove(2);
+    EXPECT_EQ(map.size(), 2);
+    EXPECT_FALSE(map.contains(2));
+    EXPECT_THROW(map.remove(2), std::exception);
+
+    std::vector<int> keys;
+    map.postorder([&](const int& key, const std::string&) {
+        keys.push_back(key);
+    });
+    EXPECT_EQ(keys.size(), 2);
+
+    map.clear();
+    EXPECT_EQ(map.size(), 0);
+    EXPECT_TRUE(map.begin() == map.end());
+}
+
+TEST_F(MyMapTest, RedBlackTreeStaysBalancedOnSortedKeys) {
+    RedBlackTree<int, int> tree;
+    const int n = 100000;
+    for (int i = 0; i < n; i++) {
+        tree.insert(i, 2 * i);
+    }
+    EXPECT_EQ(tree.size(), n);
+    EXPECT_LE(tree.height(), 34u);
+
+    for (int i = 0; i < n; i += 3) {
+        tree.remove(i);
+    }
+    EXPECT_LE(tree.height(), 34u);
+
+    int expected = 1;
+    size_t count = 0;
+    for (auto it = tree.begin(); it != tree.end(); ++it, ++count) {
+        EXPECT_EQ(it.key(), expected);
+        EXPECT_EQ(*it, 2 * expected);
+        expected += expected % 3 == 1 ? 1 : 2;
+    }
+    EXPECT_EQ(count, tree.size());
+
+    RedBlackTree<int, int, GreaterComparator> reversed;
+    for (int i = 0; i < 1000; i++) {
+        reversed.insert(i, i);
+    }
+    EXPECT_EQ(reversed.begin().key(), 999);
+    EXPECT_NE(reversed.find(500), nullptr);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();